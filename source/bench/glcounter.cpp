@@ -0,0 +1,115 @@
+#include "glcounter.h"
+#include <algorithm>
+#include <atomic>
+#include <glad/glad.h>
+
+namespace {
+
+const int MAX_FUNCTIONS = 64;
+std::atomic<uint64_t> calls[MAX_FUNCTIONS];
+const char* names[MAX_FUNCTIONS];
+int functionCount = 0;
+
+template<int Id, typename R, typename... Args>
+struct Hook {
+    static R (APIENTRYP real)(Args...);
+    static R APIENTRY call(Args... args) {
+        calls[Id].fetch_add(1, std::memory_order_relaxed);
+        return real(args...);
+    }
+};
+
+template<int Id, typename R, typename... Args>
+R (APIENTRYP Hook<Id, R, Args...>::real)(Args...) = nullptr;
+
+template<int Id, typename R, typename... Args>
+void hook(R (APIENTRYP& function)(Args...), const char* name) {
+    static_assert(Id < MAX_FUNCTIONS, "Too many hooked GL functions");
+    if (!function) return;
+    Hook<Id, R, Args...>::real = function;
+    function = &Hook<Id, R, Args...>::call;
+    names[Id] = name;
+    functionCount = std::max(functionCount, Id + 1);
+}
+
+} // namespace
+
+#define HOOK(id, name) hook<id>(glad_##name, #name)
+
+void GLCounter::install() {
+    // Everything the engine calls per frame; setup-only calls are left alone
+    HOOK(0, glActiveTexture);
+    HOOK(1, glBindBuffer);
+    HOOK(2, glBindBufferBase);
+    HOOK(3, glBindFramebuffer);
+    HOOK(4, glBindRenderbuffer);
+    HOOK(5, glBindTexture);
+    HOOK(6, glBindVertexArray);
+    HOOK(7, glBlendFunc);
+    HOOK(8, glBufferData);
+    HOOK(9, glBufferSubData);
+    HOOK(10, glClear);
+    HOOK(11, glClearColor);
+    HOOK(12, glClientWaitSync);
+    HOOK(13, glDeleteBuffers);
+    HOOK(14, glDeleteSync);
+    HOOK(15, glDeleteVertexArrays);
+    HOOK(16, glDepthFunc);
+    HOOK(17, glDepthMask);
+    HOOK(18, glDisable);
+    HOOK(19, glDrawArrays);
+    HOOK(20, glDrawElements);
+    HOOK(21, glDrawElementsInstanced);
+    HOOK(22, glEnable);
+    HOOK(23, glEnableVertexAttribArray);
+    HOOK(24, glFenceSync);
+    HOOK(25, glFlush);
+    HOOK(26, glGenBuffers);
+    HOOK(27, glGenVertexArrays);
+    HOOK(28, glLineWidth);
+    HOOK(29, glMapBufferRange);
+    HOOK(30, glPixelStorei);
+    HOOK(31, glReadPixels);
+    HOOK(32, glRenderbufferStorage);
+    HOOK(33, glTexBuffer);
+    HOOK(34, glUniform1f);
+    HOOK(35, glUniform1i);
+    HOOK(36, glUniform3fv);
+    HOOK(37, glUniform4fv);
+    HOOK(38, glUniformMatrix4fv);
+    HOOK(39, glUnmapBuffer);
+    HOOK(40, glUseProgram);
+    HOOK(41, glVertexAttribPointer);
+    HOOK(42, glViewport);
+    HOOK(43, glWaitSync);
+    HOOK(44, glVertexAttribIPointer);
+}
+
+#undef HOOK
+
+void GLCounter::reset() {
+    for (int i = 0; i < functionCount; ++i) {
+        calls[i] = 0;
+    }
+}
+
+uint64_t GLCounter::total() {
+    uint64_t sum = 0;
+    for (int i = 0; i < functionCount; ++i) {
+        sum += calls[i];
+    }
+    return sum;
+}
+
+std::vector<GLCounter::Count> GLCounter::counts() {
+    std::vector<Count> result;
+    for (int i = 0; i < functionCount; ++i) {
+        if (names[i] && calls[i] > 0) {
+            result.push_back({names[i], calls[i]});
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const Count& a, const Count& b) {
+        return a.calls != b.calls ? a.calls > b.calls : a.name < b.name;
+    });
+    return result;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Counts the engine's GL calls by swapping glad's function pointers for
+// forwarding wrappers. Nothing in the engine changes, so counts are
+// comparable across commits. Install only after the last gladLoadGL call,
+// which would restore the original pointers.
+namespace GLCounter {
+    struct Count {
+        std::string name;
+        uint64_t calls;
+    };
+
+    void install();
+    void reset();
+    uint64_t total();
+    // Functions called at least once, most called first
+    std::vector<Count> counts();
+}
@@ -0,0 +1,272 @@
+#include "../utils/window.h"
+#include "../utils/renderer.h"
+#include "../utils/presentscheduler.h"
+#include "../utils/sceneloader.h"
+#include "scenegenerator.h"
+#include "glcounter.h"
+#include "objparsebench.h"
+#include <nlohmann/json.hpp>
+#include <imgui.h>
+#include <imgui/backends/imgui_impl_sdl2.h>
+#include <imgui/backends/imgui_impl_opengl3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifndef BENCH_REVISION
+#define BENCH_REVISION "unknown"
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+    return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+// Resident set size in kilobytes from /proc; -1 where that does not exist
+static long readMemoryKb(const char* field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    size_t length = std::strlen(field);
+    while (std::getline(status, line)) {
+        if (line.compare(0, length, field) == 0 && line.size() > length && line[length] == ':') {
+            return std::strtol(line.c_str() + length + 1, nullptr, 10);
+        }
+    }
+    return -1;
+}
+
+static void usage() {
+    std::cerr << "Usage: bench [--cubes N] [--circles N] [--triangles N] [--meshes N] [--mesh file.obj]\n"
+                 "             [--lights M] [--windows K] [--width W] [--height H] [--seed S]\n"
+                 "             [--quantize 0|1] [--frames F] [--warmup F] [--animate FRACTION] [--groups SIZE]\n"
+                 "             [--output result.json]\n"
+                 "       bench --parse-obj file.obj|sphere [--repeat N] [--threads T] [--output result.json]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    SyntheticSceneParams params;
+    int frames = 300;
+    int warmup = 30;
+    bool quantize = true;
+    float animateFraction = 0.0f;   // Shapes rotated every frame, to time transform and instance updates
+    std::string parsePath;
+    int repeats = 3;
+    unsigned threads = 0;
+    std::string output;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 2;
+        }
+        const char* value = argv[++i];
+        if (std::strcmp(arg, "--cubes") == 0) params.cubes = std::atoi(value);
+        else if (std::strcmp(arg, "--circles") == 0) params.circles = std::atoi(value);
+        else if (std::strcmp(arg, "--triangles") == 0) params.triangles = std::atoi(value);
+        else if (std::strcmp(arg, "--meshes") == 0) params.meshes = std::atoi(value);
+        else if (std::strcmp(arg, "--mesh") == 0) params.meshPath = value;
+        else if (std::strcmp(arg, "--lights") == 0) params.spotlights = std::atoi(value);
+        else if (std::strcmp(arg, "--windows") == 0) params.windows = std::max(1, std::atoi(value));
+        else if (std::strcmp(arg, "--width") == 0) params.width = std::atoi(value);
+        else if (std::strcmp(arg, "--height") == 0) params.height = std::atoi(value);
+        else if (std::strcmp(arg, "--seed") == 0) params.seed = (uint32_t)std::strtoul(value, nullptr, 10);
+        else if (std::strcmp(arg, "--quantize") == 0) quantize = std::atoi(value) != 0;
+        else if (std::strcmp(arg, "--frames") == 0) frames = std::max(1, std::atoi(value));
+        else if (std::strcmp(arg, "--warmup") == 0) warmup = std::max(0, std::atoi(value));
+        else if (std::strcmp(arg, "--animate") == 0) animateFraction = std::min(1.0f, std::max(0.0f, (float)std::atof(value)));
+        else if (std::strcmp(arg, "--groups") == 0) params.groupSize = std::max(0, std::atoi(value));
+        else if (std::strcmp(arg, "--output") == 0) output = value;
+        else if (std::strcmp(arg, "--parse-obj") == 0) parsePath = value;
+        else if (std::strcmp(arg, "--repeat") == 0) repeats = std::max(1, std::atoi(value));
+        else if (std::strcmp(arg, "--threads") == 0) threads = (unsigned)std::max(0, std::atoi(value));
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+    // OBJ parsing needs no window or GL context
+    if (!parsePath.empty()) {
+        nlohmann::json result;
+        try {
+            if (parsePath == "sphere") {
+                parsePath = (std::filesystem::temp_directory_path() / "bench_parse_sphere.obj").string();
+                writeSphereObj(parsePath, 1024, 2048);
+            }
+            result = runObjParseBench(parsePath, repeats, threads);
+            result["revision"] = BENCH_REVISION;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        if (output.empty()) {
+            std::cout << result.dump(2) << std::endl;
+        } else {
+            std::ofstream file(output);
+            file << result.dump(2) << std::endl;
+        }
+        return 0;
+    }
+
+    std::vector<Window*> windows;
+    std::vector<Renderer*> renderers;
+    Scene* scene = nullptr;
+    SceneSnapshot snapshot = SceneSnapshot();
+    PresentScheduler scheduler;
+    nlohmann::json result;
+
+    try {
+        if (params.meshes > 0 && params.meshPath.empty()) {
+            params.meshPath = (std::filesystem::temp_directory_path() / "bench_sphere.obj").string();
+            writeSphereObj(params.meshPath, 32, 64);
+        }
+        nlohmann::json sceneJson = generateScene(params);
+
+        // Same setup as the editor's headless mode
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+        Clock::time_point startupBegin = Clock::now();
+        SceneLoader loader; // Parsed from text like the editor's scene.json
+        loader.loadString(sceneJson.dump());
+        for (const auto& win : loader.getWindows()) {
+            SDL_GLContext sharedContext = windows.empty() ? nullptr : windows.front()->GetGLContext();
+            Window* window = new Window(params.width, params.height, sharedContext, WINDOW_MAIN, true);
+            windows.push_back(window);
+            if (!scene) {
+                window->renderer->getResources()->getGeometryCache().setQuantizePositions(quantize);
+                scene = new Scene(window->renderer->getResources()->getGeometryCache());
+            }
+            window->renderer->setScene(scene);
+            window->LoadFromJSON(win);
+            window->SetDrawsImGui(false);
+            renderers.push_back(window->renderer);
+        }
+        loader.addTo(*scene);
+        for (Window* window : windows) {
+            scheduler.addWindow(window);
+        }
+        SDL_GL_MakeCurrent(windows.front()->GetWindow(), windows.front()->GetGLContext());
+        double startupMs = std::chrono::duration<double, std::milli>(Clock::now() - startupBegin).count();
+        const char* glRenderer = (const char*)glGetString(GL_RENDERER);
+
+        // Animated shapes are spread evenly over the scene; with groups, a
+        // moved parent moves its whole group
+        std::vector<Shape*> animated;
+        const std::vector<Shape*>& shapes = scene->getShapes();
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            if (std::floor((i + 1) * animateFraction) > std::floor(i * animateFraction)) {
+                animated.push_back(shapes[i]);
+            }
+        }
+
+        GLCounter::install();
+        std::vector<double> frameMs;
+        uint64_t drawCalls = 0;
+        uint64_t visible = 0;
+        int state = 1;
+        for (int frame = 0; frame < warmup + frames; ++frame) {
+            if (frame == warmup) {
+                GLCounter::reset();
+            }
+            SDL_PumpEvents();
+
+            Clock::time_point frameBegin = Clock::now();
+            scheduler.beginFrame();
+            SDL_GL_MakeCurrent(windows.front()->GetWindow(), windows.front()->GetGLContext());
+            for (Shape* shape : animated) {
+                glm::vec3 rotation = shape->getRotation();
+                shape->setRotation(glm::vec3(rotation.x, std::fmod(rotation.y + 1.0f, 360.0f), rotation.z));
+            }
+            scene->update();
+            scene->buildSnapshot(snapshot, false);
+            scheduler.drawFrame(snapshot, &state, renderers);
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - frameBegin).count();
+
+            // Drain every context outside the timed region, so frames do not
+            // pay for the GPU work queued by the ones before them
+            for (Window* window : windows) {
+                SDL_GL_MakeCurrent(window->GetWindow(), window->GetGLContext());
+                glFinish();
+            }
+
+            if (frame >= warmup) {
+                frameMs.push_back(ms);
+                for (Renderer* renderer : renderers) {
+                    drawCalls += renderer->getDrawCallCount();
+                    visible += renderer->getVisibleCount();
+                }
+            }
+        }
+
+        std::vector<double> sorted = frameMs;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (double ms : frameMs) sum += ms;
+
+        nlohmann::json glCalls = nlohmann::json::object();
+        for (const GLCounter::Count& count : GLCounter::counts()) {
+            glCalls[count.name] = (double)count.calls / frames;
+        }
+
+        result["revision"] = BENCH_REVISION;
+        result["glRenderer"] = glRenderer ? glRenderer : "";
+        result["params"] = {
+            {"cubes", params.cubes}, {"circles", params.circles}, {"triangles", params.triangles},
+            {"meshes", params.meshes}, {"spotlights", params.spotlights}, {"windows", params.windows},
+            {"width", params.width}, {"height", params.height}, {"seed", params.seed},
+            {"quantize", quantize}, {"frames", frames}, {"warmup", warmup},
+            {"animate", animateFraction}, {"groupSize", params.groupSize}
+        };
+        result["animatedPerFrame"] = animated.size();
+        result["startupMs"] = startupMs;
+        result["frameTimeMs"] = {
+            {"mean", sum / frames}, {"p50", percentile(sorted, 50.0)}, {"p95", percentile(sorted, 95.0)},
+            {"p99", percentile(sorted, 99.0)}, {"max", sorted.back()}
+        };
+        result["drawCallsPerFrame"] = (double)drawCalls / frames;
+        result["visiblePerFrame"] = (double)visible / frames;
+        result["glCallsPerFrame"] = (double)GLCounter::total() / frames;
+        result["glCalls"] = glCalls;
+        result["memory"] = {{"rssKb", readMemoryKb("VmRSS")}, {"peakRssKb", readMemoryKb("VmHWM")}};
+
+        SDL_GL_MakeCurrent(windows.front()->GetWindow(), windows.front()->GetGLContext());
+        delete scene;
+        scene = nullptr;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        result = nlohmann::json();
+        if (scene && !windows.empty()) {
+            SDL_GL_MakeCurrent(windows.front()->GetWindow(), windows.front()->GetGLContext());
+        }
+        delete scene;
+    }
+
+    for (Window* window : windows) {
+        delete window;
+    }
+    if (!windows.empty()) {
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui_ImplSDL2_Shutdown();
+        ImGui::DestroyContext();
+    }
+    SDL_Quit();
+
+    if (result.is_null()) {
+        return 1;
+    }
+    if (output.empty()) {
+        std::cout << result.dump(2) << std::endl;
+    } else {
+        std::ofstream file(output);
+        file << result.dump(2) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "objparsebench.h"
+#include "../utils/objparser.h"
+#include <tinyobjloader/tiny_obj_loader.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+struct ParseCounts {
+    size_t positions = 0;
+    size_t normals = 0;
+    size_t texcoords = 0;
+    size_t corners = 0;
+};
+
+template<typename Parse>
+static nlohmann::json timeRuns(int repeats, Parse parse) {
+    double total = 0.0;
+    double best = 0.0;
+    for (int i = 0; i < repeats; ++i) {
+        Clock::time_point start = Clock::now();
+        parse();
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        total += ms;
+        best = i == 0 ? ms : std::min(best, ms);
+    }
+    return {{"mean", total / repeats}, {"min", best}};
+}
+
+nlohmann::json runObjParseBench(const std::string& path, int repeats, unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    ParseCounts tinyCounts;
+    nlohmann::json tinyMs = timeRuns(repeats, [&] {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warn, err;
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str())) {
+            throw std::runtime_error("tinyobjloader failed on " + path + ": " + err);
+        }
+        tinyCounts = {attrib.vertices.size() / 3, attrib.normals.size() / 3, attrib.texcoords.size() / 2, 0};
+        for (const auto& shape : shapes) tinyCounts.corners += shape.mesh.indices.size();
+    });
+
+    ParseCounts parserCounts;
+    nlohmann::json parserMs = timeRuns(repeats, [&] {
+        ObjData data;
+        ObjParser::parse(path, data, threads);
+        parserCounts = {data.positions.size() / 3, data.normals.size() / 3, data.texcoords.size() / 2, data.corners.size()};
+    });
+
+    double fileBytes = (double)std::filesystem::file_size(path);
+    double parserBest = parserMs["min"].get<double>();
+    return {
+        {"file", path},
+        {"fileBytes", fileBytes},
+        {"threads", threads},
+        {"repeats", repeats},
+        {"tinyobjMs", tinyMs},
+        {"objParserMs", parserMs},
+        {"speedup", tinyMs["min"].get<double>() / std::max(parserBest, 1e-3)},
+        {"objParserMBps", fileBytes / (1024.0 * 1024.0) / std::max(parserBest / 1000.0, 1e-6)},
+        {"counts", {{"positions", parserCounts.positions}, {"normals", parserCounts.normals},
+                    {"texcoords", parserCounts.texcoords}, {"corners", parserCounts.corners}}},
+        {"countsMatch", tinyCounts.positions == parserCounts.positions && tinyCounts.normals == parserCounts.normals &&
+                        tinyCounts.texcoords == parserCounts.texcoords && tinyCounts.corners == parserCounts.corners}
+    };
+}
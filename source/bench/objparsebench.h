@@ -0,0 +1,8 @@
+#pragma once
+#include <string>
+#include <nlohmann/json.hpp>
+
+// Times ObjParser against tinyobjloader on one file, each run `repeats`
+// times, and checks that both read the same number of attributes and
+// triangle corners.
+nlohmann::json runObjParseBench(const std::string& path, int repeats, unsigned threads);
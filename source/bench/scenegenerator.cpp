@@ -0,0 +1,109 @@
+#include "scenegenerator.h"
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+static const float PI = 3.14159265358979f;
+
+// std::uniform_real_distribution differs between standard libraries; the
+// raw mt19937 sequence does not
+static float uniform(std::mt19937& rng, float lo, float hi) {
+    return lo + (hi - lo) * (float)(rng() / 4294967296.0);
+}
+
+void writeSphereObj(const std::string& path, int rings, int segments) {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to write " + path);
+    }
+    for (int r = 0; r <= rings; ++r) {
+        float phi = PI * r / rings;
+        for (int s = 0; s <= segments; ++s) {
+            float theta = 2.0f * PI * s / segments;
+            float x = std::sin(phi) * std::cos(theta);
+            float y = std::cos(phi);
+            float z = std::sin(phi) * std::sin(theta);
+            file << "v " << x * 0.5f << " " << y * 0.5f << " " << z * 0.5f << "\n";
+            file << "vn " << x << " " << y << " " << z << "\n";
+            file << "vt " << (float)s / segments << " " << 1.0f - (float)r / rings << "\n";
+        }
+    }
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < segments; ++s) {
+            int a = r * (segments + 1) + s + 1; // OBJ indices are 1-based
+            int b = a + segments + 1;
+            file << "f " << a << "/" << a << "/" << a << " " << b << "/" << b << "/" << b << " "
+                 << a + 1 << "/" << a + 1 << "/" << a + 1 << "\n";
+            file << "f " << a + 1 << "/" << a + 1 << "/" << a + 1 << " " << b << "/" << b << "/" << b << " "
+                 << b + 1 << "/" << b + 1 << "/" << b + 1 << "\n";
+        }
+    }
+}
+
+nlohmann::json generateScene(const SyntheticSceneParams& params) {
+    std::mt19937 rng(params.seed);
+    nlohmann::json scene;
+
+    // Children are placed near their group's first shape; without groups
+    // the scene is the same as before groups existed
+    nlohmann::json shapes = nlohmann::json::array();
+    auto addShapes = [&](const char* type, int count) {
+        for (int i = 0; i < count; ++i) {
+            nlohmann::json shape;
+            shape["type"] = type;
+            if (std::string(type) == "Mesh") shape["objPath"] = params.meshPath;
+            size_t index = shapes.size();
+            bool child = params.groupSize > 1 && index % params.groupSize != 0;
+            float spread = child ? 2.0f : params.extent;
+            shape["position"] = {uniform(rng, -spread, spread), uniform(rng, -spread, spread), uniform(rng, -spread, spread)};
+            if (child) shape["parent"] = index - index % params.groupSize;
+            shape["rotation"] = {uniform(rng, 0.0f, 360.0f), uniform(rng, 0.0f, 360.0f), uniform(rng, 0.0f, 360.0f)};
+            float scale = uniform(rng, 0.25f, 1.5f);
+            shape["scale"] = {scale, scale, scale};
+            float alpha = uniform(rng, 0.0f, 1.0f) < params.transparentFraction ? 0.5f : 1.0f;
+            shape["color"] = {uniform(rng, 0.2f, 1.0f), uniform(rng, 0.2f, 1.0f), uniform(rng, 0.2f, 1.0f), alpha};
+            shapes.push_back(shape);
+        }
+    };
+    addShapes("Cube", params.cubes);
+    addShapes("Circle", params.circles);
+    addShapes("Triangle", params.triangles);
+    addShapes("Mesh", params.meshes);
+    scene["shapes"] = shapes;
+
+    nlohmann::json spotlights = nlohmann::json::array();
+    for (int i = 0; i < params.spotlights; ++i) {
+        nlohmann::json light;
+        light["name"] = "Spotlight " + std::to_string(i);
+        light["position"] = {uniform(rng, -params.extent, params.extent), params.extent,
+                             uniform(rng, -params.extent, params.extent)};
+        light["direction"] = {uniform(rng, -0.5f, 0.5f), -1.0f, uniform(rng, -0.5f, 0.5f)};
+        light["color"] = {uniform(rng, 0.5f, 1.0f), uniform(rng, 0.5f, 1.0f), uniform(rng, 0.5f, 1.0f), 1.0f};
+        light["cutoff"] = uniform(rng, 20.0f, 45.0f);
+        light["intensity"] = uniform(rng, 0.5f, 2.0f);
+        spotlights.push_back(light);
+    }
+    scene["spotlights"] = spotlights;
+
+    // Cameras circle the origin at a fixed height, all looking at it
+    nlohmann::json windows = nlohmann::json::array();
+    float radius = params.extent * 2.25f;
+    float height = params.extent * 0.5f;
+    for (int i = 0; i < params.windows; ++i) {
+        float angle = 2.0f * PI * i / params.windows;
+        nlohmann::json window;
+        window["title"] = "Bench view " + std::to_string(i);
+        window["type"] = "WINDOW_MAIN";
+        window["width"] = (unsigned int)params.width;
+        window["height"] = (unsigned int)params.height;
+        window["camera"] = {
+            {"position", {radius * std::sin(angle), height, radius * std::cos(angle)}},
+            {"rotation", {std::atan2(height, radius) * 180.0f / PI, -angle * 180.0f / PI, 0.0f}},
+            {"fov", 60.0f}
+        };
+        windows.push_back(window);
+    }
+    scene["windows"] = windows;
+    return scene;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+// Parameters of a synthetic benchmark scene. The same parameters always
+// produce the same scene, so runs on different commits are comparable.
+struct SyntheticSceneParams {
+    int cubes = 1000;
+    int circles = 0;
+    int triangles = 0;
+    int meshes = 0;
+    int spotlights = 4;
+    int windows = 1;
+    int width = 800;
+    int height = 600;
+    float extent = 20.0f;           // Shapes are spread over [-extent, extent] on each axis
+    float transparentFraction = 0.1f;
+    int groupSize = 0;              // Shapes per hierarchy group, the first being the others' parent; 0 for none
+    uint32_t seed = 1;
+    std::string meshPath;           // OBJ used for meshes; generated when empty
+};
+
+// Writes a UV sphere with normals and texture coordinates as OBJ
+void writeSphereObj(const std::string& path, int rings, int segments);
+
+// Builds a scene.json document: shapes, grouped under parents when
+// groupSize is set, and spotlights, plus one window per view with its
+// camera circling the origin.
+nlohmann::json generateScene(const SyntheticSceneParams& params);
@@ -1,34 +1,109 @@
 #include "utils/window.h"
 #include "utils/renderer.h" // Added for Renderer definition
+#include "utils/presentscheduler.h"
+#include "utils/renderthread.h"
+#include "utils/sceneloader.h"
+#include "utils/scenefile.h"
 #include <nlohmann/json.hpp>
-#include <fstream>
 #include <stdexcept>
 #include <vector>
 #include <imgui.h>
 #include <imgui/backends/imgui_impl_sdl2.h>
 #include <imgui/backends/imgui_impl_opengl3.h>
 #include <iostream>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <filesystem>
 
 // Constants
 const unsigned int DEF_WINDOW_W = 800;
 const unsigned int DEF_WINDOW_H = 600;
 
-int main() {
+// Threads finish their frame in flight before they stop
+static void stopRenderThreads(std::vector<RenderThread*>& renderThreads) {
+    for (RenderThread* thread : renderThreads) {
+        delete thread;
+    }
+    renderThreads.clear();
+}
+
+// The newer of scene.json and the editor's saved snapshot, so edits made to
+// either after the other was last written are not ignored
+static std::string defaultScenePath() {
+    const std::string jsonPath = "scene.json";
+    const std::string snapshotPath = SceneFile::DEFAULT_PATH;
+    std::error_code jsonError, snapshotError;
+    auto jsonTime = std::filesystem::last_write_time(jsonPath, jsonError);
+    auto snapshotTime = std::filesystem::last_write_time(snapshotPath, snapshotError);
+    std::string path, reason;
+    if (snapshotError) {
+        path = jsonPath;
+        reason = "no " + snapshotPath;
+    } else if (jsonError) {
+        path = snapshotPath;
+        reason = "no " + jsonPath;
+    } else if (jsonTime > snapshotTime) {
+        path = jsonPath;
+        reason = "newer than " + snapshotPath;
+    } else {
+        path = snapshotPath;
+        reason = "saved after " + jsonPath + " last changed";
+    }
+    std::cout << "Scene: " << path << " (" << reason << ")" << std::endl;
+    return path;
+}
+
+int main(int argc, char* argv[]) {
     std::vector<Window*> windows;
     std::vector<Renderer*> renderers;
+    std::vector<RenderThread*> renderThreads;
+    Scene* scene = nullptr;
+    SceneSnapshot snapshot = SceneSnapshot();
+    PresentScheduler scheduler;
+
+    // --threaded gives every 3D view but the primary its own render thread.
+    // --headless renders hidden windows offscreen, --frames N stops after N
+    // frames and --capture DIR writes each headless frame there as PPM.
+    // --mesh-cache DIR keeps packed meshes there instead of beside each .obj.
+    // --scene FILE loads a scene.json or binary snapshot; by default the
+    // newer of scene.json and the editor's saved snapshot is loaded.
+    bool threaded = false;
+    bool headless = false;
+    long frameLimit = -1;
+    std::string captureDirectory;
+    std::string meshCacheDirectory;
+    std::string scenePath;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threaded") == 0) threaded = true;
+        else if (std::strcmp(argv[i], "--headless") == 0) headless = true;
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) frameLimit = std::strtol(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc) captureDirectory = argv[++i];
+        else if (std::strcmp(argv[i], "--mesh-cache") == 0 && i + 1 < argc) meshCacheDirectory = argv[++i];
+        else if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) scenePath = argv[++i];
+    }
+    if (scenePath.empty()) {
+        scenePath = defaultScenePath();
+    } else {
+        std::cout << "Scene: " << scenePath << " (from --scene)" << std::endl;
+    }
+    if (headless) {
+        // Needs no display; with Mesa, LIBGL_ALWAYS_SOFTWARE=1 selects llvmpipe
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+    }
 
     try {
-        // Load scene.json
-        nlohmann::json scene;
-        std::ifstream file("scene.json");
-        if (file.is_open()) {
-            file >> scene;
-            file.close();
+        auto startupBegin = std::chrono::steady_clock::now();
+
+        // Load the scene; entities are built here, before any window exists
+        SceneLoader loader;
+        if (loader.loadFile(scenePath)) {
+            std::cout << "Loaded " << scenePath << ": " << loader.getEntityCount() << " entities" << std::endl;
         }
 
         // Create windows from JSON
-        if (scene.contains("windows") && scene["windows"].is_array()) {
-            for (const auto& win : scene["windows"]) {
+        if (!loader.getWindows().empty()) {
+            for (const auto& win : loader.getWindows()) {
                 WindowType type = WINDOW_MAIN;
                 if (win.contains("type") && win["type"].is_string()) {
                     std::string typeStr = win["type"].get<std::string>();
@@ -42,20 +117,67 @@ int main() {
                 unsigned int height = win.contains("height") && win["height"].is_number_unsigned()
                     ? win["height"].get<unsigned int>() : DEF_WINDOW_H;
 
-                Window* window = new Window(width, height, nullptr, type);
+                // All windows share the first window's GL objects
+                SDL_GLContext sharedContext = windows.empty() ? nullptr : windows.front()->GetGLContext();
+                Window* window = new Window(width, height, sharedContext, type, headless);
+                if (!scene) {
+                    window->renderer->getResources()->getGeometryCache().setMeshCacheDirectory(meshCacheDirectory);
+                    scene = new Scene(window->renderer->getResources()->getGeometryCache());
+                }
+                window->renderer->setScene(scene);
                 window->LoadFromJSON(win);
                 window->Show();
                 windows.push_back(window);
             }
         } else {
             // Create default window if no JSON or no windows
-            Window* window = new Window(DEF_WINDOW_W, DEF_WINDOW_H, nullptr, WINDOW_MAIN);
+            Window* window = new Window(DEF_WINDOW_W, DEF_WINDOW_H, nullptr, WINDOW_MAIN, headless);
+            window->renderer->getResources()->getGeometryCache().setMeshCacheDirectory(meshCacheDirectory);
+            scene = new Scene(window->renderer->getResources()->getGeometryCache());
+            window->renderer->setScene(scene);
+            window->renderer->init();
             window->Show();
             windows.push_back(window);
         }
 
-        // Main loop
-        int state = 1;
+        // Meshes the scene uses are loaded in parallel and uploaded together
+        loader.addTo(*scene);
+
+        // ImGui has a single context, so the primary and UI-only windows stay
+        // on this thread; in threaded mode the other views get their own
+        if (headless && !captureDirectory.empty()) {
+            std::filesystem::create_directories(captureDirectory);
+        }
+        std::vector<Window*> threadedWindows;
+        for (Window* window : windows) {
+            if (headless) {
+                window->SetDrawsImGui(false);
+                window->SetCaptureDirectory(captureDirectory);
+            }
+            if (threaded && window != windows.front() && window->type != WINDOW_HIERARCHY) {
+                window->SetDrawsImGui(false);
+                threadedWindows.push_back(window);
+            } else {
+                scheduler.addWindow(window);
+            }
+        }
+        // A context may be current on one thread only; this releases the rest
+        SDL_GL_MakeCurrent(windows.front()->GetWindow(), windows.front()->GetGLContext());
+        for (Window* window : threadedWindows) {
+            renderThreads.push_back(new RenderThread(window));
+        }
+
+        // Startup report
+        const ProgramCacheStats& shaderCache = ShaderProgram::getCacheStats();
+        double startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count();
+        std::cout << "Startup: " << startupMs << " ms, shader cache " << shaderCache.hits << " hits / "
+                  << shaderCache.misses << " misses (compile " << shaderCache.compileMs << " ms, load "
+                  << shaderCache.loadMs << " ms, saved " << shaderCache.savedMs << " ms)" << std::endl;
+
+        // Main loop; --frames 0 draws nothing
+        int state = frameLimit == 0 ? 0 : 1;
+        long frameCount = 0;
+        auto loopBegin = std::chrono::steady_clock::now();
         SDL_Event event;
         while (state) {
             while (SDL_PollEvent(&event)) {
@@ -63,16 +185,9 @@ int main() {
                 if (event.type == SDL_QUIT) {
                     state = 0;
                 } else if (event.type == SDL_WINDOWEVENT) {
+                    // Resizes are picked up by each window as it draws, on its own thread
                     if (event.window.event == SDL_WINDOWEVENT_CLOSE) {
                         state = 0;
-                    } else if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
-                        for (Window* window : windows) {
-                            if (SDL_GetWindowID(window->GetWindow()) == event.window.windowID) {
-                                int width, height;
-                                SDL_GetWindowSize(window->GetWindow(), &width, &height);
-                                window->renderer->updateCameraAspect(static_cast<float>(width) / height);
-                            }
-                        }
                     }
                 }
             }
@@ -85,13 +200,42 @@ int main() {
                 }
             }
 
-            // Draw windows
-            for (Window* window : windows) {
-                window->Draw(&state, renderers);
+            // Render threads must be done with the last snapshot before the scene changes
+            SDL_GL_MakeCurrent(windows.front()->GetWindow(), windows.front()->GetGLContext());
+            for (RenderThread* thread : renderThreads) {
+                thread->wait();
+            }
+
+            // Sync the shared scene once, then draw every view of it
+            scheduler.beginFrame();
+            scene->update();
+            if (snapshot.uploaded) {
+                glDeleteSync(snapshot.uploaded);
+            }
+            scene->buildSnapshot(snapshot, !renderThreads.empty());
+            for (RenderThread* thread : renderThreads) {
+                thread->submit(&snapshot, scheduler.getFrameStart());
+            }
+            scheduler.drawFrame(snapshot, &state, renderers);
+
+            if (frameLimit >= 0 && ++frameCount >= frameLimit) {
+                state = 0;
             }
         }
 
-        // Cleanup
+        if (frameLimit >= 0) {
+            double loopMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loopBegin).count();
+            std::cout << "Rendered " << frameCount << " frames in " << loopMs << " ms ("
+                      << (frameCount > 0 ? loopMs / frameCount : 0.0) << " ms/frame)" << std::endl;
+        }
+
+        // Cleanup; the scene's GL objects go while a context of the group is current
+        stopRenderThreads(renderThreads);
+        SDL_GL_MakeCurrent(windows.front()->GetWindow(), windows.front()->GetGLContext());
+        if (snapshot.uploaded) {
+            glDeleteSync(snapshot.uploaded);
+        }
+        delete scene;
         for (Window* window : windows) {
             delete window;
         }
@@ -104,6 +248,11 @@ int main() {
 
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
+        stopRenderThreads(renderThreads);
+        if (scene && !windows.empty()) {
+            SDL_GL_MakeCurrent(windows.front()->GetWindow(), windows.front()->GetGLContext());
+        }
+        delete scene;
         for (Window* window : windows) {
             delete window;
         }
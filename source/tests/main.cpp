@@ -0,0 +1,46 @@
+#include "test.h"
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+int failures = 0;
+}
+
+std::vector<Test::Case>& Test::cases() {
+    static std::vector<Case> all;
+    return all;
+}
+
+void Test::fail(const char* file, int line, const char* expression) {
+    std::cerr << file << ":" << line << ": CHECK failed: " << expression << std::endl;
+    ++failures;
+}
+
+std::string Test::tempPath(const std::string& name) {
+    std::string unique = "enginetests_" + std::to_string(getpid()) + "_" + name;
+    return (std::filesystem::temp_directory_path() / unique).string();
+}
+
+// Runs every case, or those whose name contains the first argument
+int main(int argc, char* argv[]) {
+    std::string filter = argc > 1 ? argv[1] : "";
+    int failedCases = 0, run = 0;
+    for (const Test::Case& test : Test::cases()) {
+        if (std::string(test.name).find(filter) == std::string::npos) continue;
+        int before = failures;
+        try {
+            test.run();
+        } catch (const std::exception& e) {
+            std::cerr << test.name << ": unexpected exception: " << e.what() << std::endl;
+            ++failures;
+        }
+        ++run;
+        bool passed = failures == before;
+        if (!passed) ++failedCases;
+        std::cout << (passed ? "[pass] " : "[FAIL] ") << test.name << std::endl;
+    }
+    std::cout << run - failedCases << "/" << run << " passed" << std::endl;
+    return failedCases == 0 ? 0 : 1;
+}
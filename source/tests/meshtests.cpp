@@ -0,0 +1,141 @@
+#include "test.h"
+#include "../utils/mesh.h"
+#include "../utils/meshoptimize.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+using Triangle = std::array<uint32_t, 3>;
+
+// Rotated so the smallest index comes first; winding is kept
+Triangle canonical(uint32_t a, uint32_t b, uint32_t c) {
+    if (b < a && b < c) return {b, c, a};
+    if (c < a && c < b) return {c, a, b};
+    return {a, b, c};
+}
+
+std::vector<Triangle> sortedTriangles(const std::vector<uint32_t>& indices, size_t begin, size_t end) {
+    std::vector<Triangle> triangles;
+    for (size_t i = begin; i + 2 < end; i += 3) {
+        triangles.push_back(canonical(indices[i], indices[i + 1], indices[i + 2]));
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// Triangles of an n x n grid, rows in order, so the cache has work to do
+std::vector<uint32_t> gridIndices(uint32_t n) {
+    std::vector<uint32_t> indices;
+    for (uint32_t row = 0; row < n; ++row) {
+        for (uint32_t column = 0; column < n; ++column) {
+            uint32_t a = row * (n + 1) + column, b = a + 1, c = a + n + 1, d = c + 1;
+            indices.insert(indices.end(), {a, b, d, a, d, c});
+        }
+    }
+    return indices;
+}
+
+} // namespace
+
+// Every corner of a cube has its face's normal, so the 8 positions become
+// 24 vertices; each output triangle must still be one of the input's
+TEST(meshLoadRemapsCubeCorners) {
+    std::string path = Test::tempPath("cube.obj");
+    {
+        std::ofstream file(path);
+        file << "v -1 -1 -1\nv 1 -1 -1\nv 1 1 -1\nv -1 1 -1\nv -1 -1 1\nv 1 -1 1\nv 1 1 1\nv -1 1 1\n"
+                "vn 0 0 -1\nvn 0 0 1\nvn -1 0 0\nvn 1 0 0\nvn 0 -1 0\nvn 0 1 0\n"
+                "f 1//1 4//1 3//1 2//1\nf 5//2 6//2 7//2 8//2\nf 1//3 5//3 8//3 4//3\n"
+                "f 2//4 3//4 7//4 6//4\nf 1//5 2//5 6//5 5//5\nf 4//6 8//6 7//6 3//6\n";
+    }
+    const int faces[6][4] = {{0, 3, 2, 1}, {4, 5, 6, 7}, {0, 4, 7, 3}, {1, 2, 6, 5}, {0, 1, 5, 4}, {3, 7, 6, 2}};
+    const float normals[6][3] = {{0, 0, -1}, {0, 0, 1}, {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}};
+
+    MeshData mesh;
+    Mesh::loadObj(path, mesh, 1);
+    std::remove(path.c_str());
+
+    CHECK(mesh.vertexCount() == 24);
+    CHECK(mesh.indices.size() == 36);
+    CHECK(mesh.hasNormals() && mesh.normals.size() == 24 * 3);
+    CHECK(!mesh.hasUvs());
+    if (mesh.vertexCount() != 24 || mesh.indices.size() != 36 || mesh.normals.size() != 24 * 3) return;
+
+    // Resolves each output vertex back to its OBJ position and face
+    const float cubePositions[8][3] = {{-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1},
+                                       {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}};
+    auto corner = [&](uint32_t vertex, int& position, int& face) {
+        position = face = -1;
+        for (int p = 0; p < 8; ++p) {
+            if (std::equal(cubePositions[p], cubePositions[p] + 3, &mesh.positions[3 * vertex])) position = p;
+        }
+        for (int f = 0; f < 6; ++f) {
+            if (std::equal(normals[f], normals[f] + 3, &mesh.normals[3 * vertex])) face = f;
+        }
+    };
+    std::vector<Triangle> expected, actual;
+    for (int f = 0; f < 6; ++f) {
+        expected.push_back(canonical(f * 8 + faces[f][0], f * 8 + faces[f][1], f * 8 + faces[f][2]));
+        expected.push_back(canonical(f * 8 + faces[f][0], f * 8 + faces[f][2], f * 8 + faces[f][3]));
+    }
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+        uint32_t keys[3];
+        for (int k = 0; k < 3; ++k) {
+            int position, face;
+            corner(mesh.indices[i + k], position, face);
+            CHECK(position >= 0 && face >= 0);
+            keys[k] = face * 8 + position;
+        }
+        actual.push_back(canonical(keys[0], keys[1], keys[2]));
+    }
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    CHECK(actual == expected);
+
+    // optimizeVertexFetch numbers vertices in order of first use
+    uint32_t next = 0;
+    bool firstUseOrder = true;
+    for (uint32_t index : mesh.indices) {
+        if (index == next) ++next;
+        else firstUseOrder = firstUseOrder && index < next;
+    }
+    CHECK(firstUseOrder && next == 24);
+}
+
+TEST(meshVertexCacheKeepsTrianglesPerSubmesh) {
+    const uint32_t n = 32;
+    std::vector<uint32_t> indices = gridIndices(n);
+    size_t vertexCount = (n + 1) * (n + 1);
+    std::vector<Submesh> submeshes = {{0, (uint32_t)indices.size() / 2},
+                                      {(uint32_t)indices.size() / 2, (uint32_t)indices.size() / 2}};
+    std::vector<uint32_t> optimized = indices;
+    MeshOptimize::optimizeVertexCache(optimized, vertexCount, submeshes);
+
+    CHECK(optimized.size() == indices.size());
+    for (const Submesh& submesh : submeshes) {
+        size_t begin = submesh.indexOffset, end = submesh.indexOffset + submesh.indexCount;
+        CHECK(sortedTriangles(optimized, begin, end) == sortedTriangles(indices, begin, end));
+    }
+    CHECK(MeshOptimize::computeAcmr(optimized, vertexCount) < MeshOptimize::computeAcmr(indices, vertexCount));
+}
+
+TEST(meshVertexFetchRenumbersByFirstUse) {
+    MeshData mesh;
+    mesh.positions = {0, 0, 0, 1, 0, 0, 2, 0, 0, 3, 0, 0, 4, 0, 0};
+    mesh.uvs = {0, 0, 1, 0, 2, 0, 3, 0, 4, 0};
+    mesh.indices = {4, 2, 0, 2, 4, 3}; // Vertex 1 is unused
+    MeshOptimize::optimizeVertexFetch(mesh);
+
+    CHECK((mesh.indices == std::vector<uint32_t>{0, 1, 2, 1, 0, 3}));
+    CHECK(mesh.vertexCount() == 4 && mesh.uvs.size() == 8);
+    // Attributes moved with their vertices; x was the old index
+    bool moved = mesh.vertexCount() == 4 && mesh.uvs.size() == 8;
+    for (uint32_t vertex = 0; moved && vertex < 4; ++vertex) {
+        const float oldIndex[4] = {4, 2, 0, 3};
+        moved = mesh.positions[3 * vertex] == oldIndex[vertex] && mesh.uvs[2 * vertex] == oldIndex[vertex];
+    }
+    CHECK(moved);
+}
@@ -0,0 +1,154 @@
+#include "test.h"
+#include "../utils/objparser.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+void writeFile(const std::string& path, const std::string& text) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << text;
+}
+
+bool sameCorners(const ObjData& a, const ObjData& b) {
+    if (a.corners.size() != b.corners.size()) return false;
+    for (size_t i = 0; i < a.corners.size(); ++i) {
+        const ObjData::Corner& x = a.corners[i];
+        const ObjData::Corner& y = b.corners[i];
+        if (x.position != y.position || x.texcoord != y.texcoord || x.normal != y.normal) return false;
+    }
+    return true;
+}
+
+bool sameGroups(const ObjData& a, const ObjData& b) {
+    if (a.groups.size() != b.groups.size()) return false;
+    for (size_t i = 0; i < a.groups.size(); ++i) {
+        if (a.groups[i].indexOffset != b.groups[i].indexOffset || a.groups[i].indexCount != b.groups[i].indexCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A size x size grid of quads, one group per row, written row by row so
+// faces come between vertex statements. With relative set, faces index
+// backwards from the vertices read so far; otherwise they are 1-based.
+void writeGrid(const std::string& path, int size, bool relative) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    char line[160];
+    int columns = size + 1;
+    for (int row = 0; row <= size; ++row) {
+        for (int column = 0; column <= size; ++column) {
+            std::snprintf(line, sizeof(line), "v %g %g %g\nvt %g %g\n", column * 0.5, row * 0.25, (row ^ column) * 0.001,
+                          (double)column / size, (double)row / size);
+            file << line;
+        }
+        if (row == 0) continue;
+        int seen = (row + 1) * columns;
+        std::snprintf(line, sizeof(line), "g row%d # trailing comment\n", row);
+        file << line;
+        for (int column = 0; column < size; ++column) {
+            int corners[4] = {(row - 1) * columns + column, (row - 1) * columns + column + 1,
+                              row * columns + column + 1, row * columns + column};
+            file << "f";
+            for (int corner : corners) {
+                int index = relative ? corner - seen : corner + 1;
+                std::snprintf(line, sizeof(line), " %d/%d", index, index);
+                file << line;
+            }
+            file << (column % 7 == 0 ? " # quad\n" : "\n");
+        }
+    }
+}
+
+} // namespace
+
+TEST(objChunkedParseMatchesSingleThread) {
+    std::string path = Test::tempPath("grid.obj");
+    writeGrid(path, 300, true);
+    CHECK(std::filesystem::file_size(path) >= 4 << 20); // Large enough to be split four ways
+    ObjData single, chunked;
+    ObjParser::parse(path, single, 1);
+    ObjParser::parse(path, chunked, 4);
+    std::remove(path.c_str());
+
+    CHECK(single.positions.size() == 301 * 301 * 3);
+    CHECK(single.corners.size() == 300 * 300 * 6);
+    CHECK(single.groups.size() == 300);
+    CHECK(single.positions == chunked.positions);
+    CHECK(single.texcoords == chunked.texcoords);
+    CHECK(single.normals.empty() && chunked.normals.empty());
+    CHECK(sameCorners(single, chunked));
+    CHECK(sameGroups(single, chunked));
+}
+
+TEST(objRelativeIndicesMatchAbsolute) {
+    std::string relativePath = Test::tempPath("relative.obj");
+    std::string absolutePath = Test::tempPath("absolute.obj");
+    writeGrid(relativePath, 200, true);
+    writeGrid(absolutePath, 200, false);
+    ObjData relative, absolute;
+    ObjParser::parse(relativePath, relative, 3);
+    ObjParser::parse(absolutePath, absolute, 3);
+    std::remove(relativePath.c_str());
+    std::remove(absolutePath.c_str());
+
+    CHECK(!relative.corners.empty());
+    CHECK(sameCorners(relative, absolute));
+    CHECK(sameGroups(relative, absolute));
+}
+
+TEST(objNegativeIndicesCountStatementsSoFar) {
+    std::string path = Test::tempPath("negative.obj");
+    writeFile(path,
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+        "vn 0 0 1\n"
+        "f -3//-1 -2//-1 -1//-1\n"
+        "v 1 1 0\n"
+        "f 2//1 -1//1 3//1\n");
+    ObjData data;
+    ObjParser::parse(path, data, 1);
+    std::remove(path.c_str());
+
+    CHECK(data.corners.size() == 6);
+    if (data.corners.size() != 6) return;
+    int expected[6] = {0, 1, 2, 1, 3, 2};
+    for (int i = 0; i < 6; ++i) {
+        CHECK(data.corners[i].position == expected[i]);
+        CHECK(data.corners[i].normal == 0);
+        CHECK(data.corners[i].texcoord == -1);
+    }
+}
+
+TEST(objCommentsEndStatements) {
+    std::string path = Test::tempPath("comments.obj");
+    writeFile(path,
+        "# header\n"
+        "v 0 0 0 # origin\n"
+        "v 1 0 0\n"
+        "v 0 1 0#no blank\n"
+        "vt 0.5 # one coordinate\n"
+        "f 1 2 3 # comment\n"
+        "f 1 2 3#4\n"
+        "# f 9 9 9\n");
+    ObjData data;
+    ObjParser::parse(path, data, 1);
+    std::remove(path.c_str());
+
+    CHECK(data.positions.size() == 9);
+    CHECK(data.positions[7] == 1.0f);
+    CHECK(data.texcoords.size() == 2 && data.texcoords[0] == 0.5f && data.texcoords[1] == 0.0f);
+    CHECK(data.corners.size() == 6);
+}
+
+TEST(objRejectsIndicesOutOfRange) {
+    std::string path = Test::tempPath("range.obj");
+    const char* faces[] = {"f 1 2 4\n", "f 0 1 2\n", "f -4 -2 -1\n", "f 1/1 2/1 3/1\n", "f /1 2 3\n"};
+    for (const char* face : faces) {
+        writeFile(path, std::string("v 0 0 0\nv 1 0 0\nv 0 1 0\n") + face);
+        ObjData data;
+        CHECK_THROWS(ObjParser::parse(path, data, 1));
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,132 @@
+#include "test.h"
+#include "../utils/sceneloader.h"
+#include "../utils/scenefile.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+const char* SCENE = R"({
+    "windows": [
+        {"type": "WINDOW_MAIN", "title": "Main", "width": 800, "height": 600,
+         "camera": {"position": [0.0, 2.5, 10.0], "rotation": [-10.0, 0.0, 0.0], "fov": 60.0}},
+        {"type": "WINDOW_HIERARCHY", "title": "Hierarchy"}
+    ],
+    "shapes": [
+        {"type": "Cube", "position": [1.0, 2.0, 3.0], "rotation": [0.0, 45.0, 0.0], "parent": 2},
+        {"type": "Circle", "color": [0.25, 0.5, 0.75, 0.5]},
+        {"type": "Mesh", "objPath": "models/teapot.obj", "scale": [2.0, 2.0, 2.0]},
+        {"type": "Triangle", "parent": 0}
+    ],
+    "spotlights": [{"name": "Key", "position": [0.0, 5.0, 0.0], "direction": [0.0, -1.0, 0.0], "cutoff": 30.0, "intensity": 1.5}],
+    "gameCameras": [{"name": "Player", "position": [0.0, 1.5, 4.0], "fov": 70.0}]
+})";
+
+nlohmann::json entities(const SceneLoader& loader) {
+    return SceneLoader::toJSON({}, loader.getShapes(), loader.getSpotlights(), loader.getGameCameras());
+}
+
+std::string readBytes(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeBytes(const std::string& path, const std::string& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), bytes.size());
+}
+
+// Writes SCENE as a snapshot and returns its bytes
+std::string snapshotBytes(const std::string& path, SceneLoader& source) {
+    source.loadString(SCENE);
+    bool written = SceneFile::write(path, source.getWindows(), source.getShapes(), source.getSpotlights(),
+                                    source.getGameCameras());
+    CHECK(written);
+    return readBytes(path);
+}
+
+// Header fields the tests patch: the version, and the offset of the
+// shape parents block, the last of the version 2 header's block table
+const size_t VERSION_OFFSET = 4;
+const size_t PARENTS_BLOCK_OFFSET = 32 + 19 * 16;
+
+} // namespace
+
+TEST(snapshotRoundTripsJson) {
+    std::string path = Test::tempPath("roundtrip.oscene");
+    SceneLoader source;
+    snapshotBytes(path, source);
+    SceneLoader loaded;
+    bool opened = loaded.loadFile(path);
+    std::remove(path.c_str());
+
+    CHECK(opened);
+    CHECK(entities(loaded) == entities(source));
+    CHECK(loaded.getWindows() == source.getWindows());
+    CHECK(loaded.getShapes().size() == 4);
+    if (loaded.getShapes().size() != 4) return;
+    CHECK(loaded.getShapes().parents[0] == 2);
+    CHECK(loaded.getShapes().parents[3] == 0);
+}
+
+TEST(snapshotVersion1HasNoParents) {
+    std::string path = Test::tempPath("version1.oscene");
+    SceneLoader source;
+    std::string bytes = snapshotBytes(path, source);
+    uint32_t version = 1;
+    std::memcpy(&bytes[VERSION_OFFSET], &version, sizeof(version));
+    writeBytes(path, bytes);
+    SceneLoader loaded;
+    loaded.loadFile(path);
+    std::remove(path.c_str());
+
+    nlohmann::json expected = entities(source);
+    for (nlohmann::json& shape : expected["shapes"]) {
+        shape.erase("parent");
+    }
+    CHECK(entities(loaded) == expected);
+    CHECK(loaded.getWindows() == source.getWindows());
+}
+
+TEST(snapshotRejectsTruncatedFiles) {
+    std::string path = Test::tempPath("truncated.oscene");
+    SceneLoader source;
+    std::string bytes = snapshotBytes(path, source);
+    for (size_t size : {(size_t)8, (size_t)100, bytes.size() / 2, bytes.size() - 1}) {
+        writeBytes(path, bytes.substr(0, size));
+        SceneLoader loaded;
+        CHECK_THROWS(loaded.loadFile(path));
+    }
+    std::remove(path.c_str());
+}
+
+TEST(snapshotRejectsBadParents) {
+    std::string path = Test::tempPath("parents.oscene");
+    SceneLoader source;
+    std::string bytes = snapshotBytes(path, source);
+    uint64_t parents = 0;
+    std::memcpy(&parents, &bytes[PARENTS_BLOCK_OFFSET], sizeof(parents));
+    CHECK(parents > 0 && parents + 4 * sizeof(uint32_t) <= bytes.size());
+    if (parents == 0 || parents + 4 * sizeof(uint32_t) > bytes.size()) return;
+
+    uint32_t outside = 4; // One past the last shape
+    std::memcpy(&bytes[parents + sizeof(uint32_t)], &outside, sizeof(outside));
+    writeBytes(path, bytes);
+    SceneLoader loaded;
+    CHECK_THROWS(loaded.loadFile(path));
+    std::remove(path.c_str());
+}
+
+TEST(snapshotRejectsOtherVersions) {
+    std::string path = Test::tempPath("version3.oscene");
+    SceneLoader source;
+    std::string bytes = snapshotBytes(path, source);
+    uint32_t version = SceneFile::VERSION + 1;
+    std::memcpy(&bytes[VERSION_OFFSET], &version, sizeof(version));
+    writeBytes(path, bytes);
+    SceneLoader loaded;
+    CHECK_THROWS(loaded.loadFile(path));
+    std::remove(path.c_str());
+}
@@ -0,0 +1,84 @@
+#include "test.h"
+#include "../utils/sceneloader.h"
+#include "../utils/mesh.h"
+
+namespace {
+
+const char* SHAPES = R"([
+    {"type": "Cube", "position": [1.0, 2.0, 3.0], "parent": 2},
+    {"type": "Bogus"},
+    {"type": "Mesh", "objPath": "model.obj", "color": [1.0, 0.0, 0.0, 1.0]},
+    {"type": "Triangle", "scale": [2.0, 2.0, 2.0], "parent": 2}
+])";
+const char* LIGHTS = R"([{"name": "Key", "cutoff": 30.0, "position": [0.0, 5.0, 0.0]}])";
+
+std::string windowWith(const std::string& shapes) {
+    return R"({"title": "View", "width": 640, "height": 480, "shapes": )" + shapes + R"(, "spotlights": )" + LIGHTS + "}";
+}
+
+} // namespace
+
+// Older files repeat the top-level lists in every window
+TEST(sceneRepeatedListsAreBuiltOnce) {
+    SceneLoader loader;
+    loader.loadString(std::string(R"({"shapes": )") + SHAPES + R"(, "spotlights": )" + LIGHTS +
+                      R"(, "windows": [)" + windowWith(SHAPES) + ", " + windowWith(SHAPES) + "]}");
+
+    const ShapeStore& shapes = loader.getShapes();
+    CHECK(shapes.size() == 3);
+    CHECK(loader.getSpotlights().size() == 1);
+    CHECK(loader.getWindows().size() == 2);
+    CHECK(!loader.getWindows()[0].contains("shapes"));
+    if (shapes.size() != 3) return;
+    CHECK(shapes.getViews()[0]->getType() == "Cube");
+    CHECK(static_cast<const Mesh*>(shapes.getViews()[1])->getObjPath() == "model.obj");
+    // Parent indices count the skipped record, and may point forwards
+    CHECK(shapes.parents[0] == 1);
+    CHECK(shapes.parents[1] == ShapeStore::NO_ID);
+    CHECK(shapes.parents[2] == 1);
+}
+
+TEST(sceneDifferentListsAreKept) {
+    std::string moved = SHAPES;
+    moved.replace(moved.find("[1.0, 2.0, 3.0]"), 15, "[1.0, 2.0, 3.5]");
+    std::string reparented = SHAPES;
+    reparented.replace(reparented.rfind("\"parent\": 2"), 11, "\"parent\": 0");
+
+    SceneLoader loader;
+    loader.loadString(std::string(R"({"shapes": )") + SHAPES + R"(, "windows": [)" + windowWith(moved) + ", " +
+                      windowWith(reparented) + ", " + windowWith(SHAPES) + "]}");
+
+    const ShapeStore& shapes = loader.getShapes();
+    CHECK(shapes.size() == 9);
+    CHECK(loader.getSpotlights().size() == 1);
+    if (shapes.size() != 9) return;
+    CHECK(shapes.positions[3].z == 3.5f);
+    CHECK(shapes.parents[3] == 4 && shapes.parents[5] == 4);
+    CHECK(shapes.parents[6] == 7 && shapes.parents[8] == 6);
+}
+
+TEST(sceneInvalidParentsAreIgnored) {
+    SceneLoader loader;
+    loader.loadString(R"({"shapes": [
+        {"type": "Cube", "parent": 0},
+        {"type": "Cube", "parent": 7},
+        {"type": "Cube", "parent": 3},
+        {"type": "Cube", "parent": 2},
+        {"type": "Bogus"},
+        {"type": "Cube", "parent": 4}
+    ]})");
+
+    const ShapeStore& shapes = loader.getShapes();
+    CHECK(shapes.size() == 5);
+    if (shapes.size() != 5) return;
+    CHECK(shapes.parents[0] == ShapeStore::NO_ID);  // Itself
+    CHECK(shapes.parents[1] == ShapeStore::NO_ID);  // Past the list
+    CHECK(shapes.parents[2] == 3);
+    CHECK(shapes.parents[3] == ShapeStore::NO_ID);  // Would close a cycle
+    CHECK(shapes.parents[4] == ShapeStore::NO_ID);  // A skipped record
+}
+
+TEST(sceneMalformedJsonThrows) {
+    SceneLoader loader;
+    CHECK_THROWS(loader.loadString(R"({"shapes": [{"type": "Cube"})"));
+}
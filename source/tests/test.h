@@ -0,0 +1,43 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// A minimal test registry, so the engine tests need nothing beyond the
+// engine itself. TEST defines a case that main() runs; CHECK records a
+// failed condition and lets the case carry on.
+namespace Test {
+    struct Case {
+        const char* name;
+        void (*run)();
+    };
+
+    std::vector<Case>& cases();
+    void fail(const char* file, int line, const char* expression);
+    // A path in the temporary directory, unique to this process
+    std::string tempPath(const std::string& name);
+
+    struct Registrar {
+        Registrar(const char* name, void (*run)()) { cases().push_back({name, run}); }
+    };
+}
+
+#define TEST(name) \
+    static void name(); \
+    static Test::Registrar name##Registrar(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) Test::fail(__FILE__, __LINE__, #condition); \
+    } while (0)
+
+#define CHECK_THROWS(statement) \
+    do { \
+        bool thrown = false; \
+        try { \
+            statement; \
+        } catch (const std::exception&) { \
+            thrown = true; \
+        } \
+        if (!thrown) Test::fail(__FILE__, __LINE__, "throws: " #statement); \
+    } while (0)
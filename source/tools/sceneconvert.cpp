@@ -0,0 +1,48 @@
+#include "../utils/sceneloader.h"
+#include "../utils/scenefile.h"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// Converts between scene.json and binary scene snapshots. The input format
+// is detected from its content; an output ending in .json is written as
+// JSON, anything else as a binary snapshot.
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " INPUT OUTPUT" << std::endl;
+        std::cerr << "  e.g. " << argv[0] << " scene.json " << SceneFile::DEFAULT_PATH << std::endl;
+        return 2;
+    }
+    std::string input = argv[1];
+    std::string output = argv[2];
+
+    try {
+        SceneLoader loader;
+        if (!loader.loadFile(input)) {
+            std::cerr << "Cannot open scene file: " << input << std::endl;
+            return 1;
+        }
+
+        bool json = output.size() >= 5 && output.compare(output.size() - 5, 5, ".json") == 0;
+        if (json) {
+            std::ofstream file(output);
+            file << SceneLoader::toJSON(loader.getWindows(), loader.getShapes(), loader.getSpotlights(),
+                                        loader.getGameCameras()).dump(4) << std::endl;
+            if (!file) {
+                std::cerr << "Cannot write scene file: " << output << std::endl;
+                return 1;
+            }
+        } else if (!SceneFile::write(output, loader.getWindows(), loader.getShapes(), loader.getSpotlights(),
+                                     loader.getGameCameras())) {
+            return 1;
+        }
+        std::cout << "Wrote " << output << ": " << loader.getWindows().size() << " windows, "
+                  << loader.getShapes().size() << " shapes, " << loader.getSpotlights().size() << " spotlights, "
+                  << loader.getGameCameras().size() << " game cameras" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
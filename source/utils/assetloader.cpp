@@ -0,0 +1,196 @@
+#include "assetloader.h"
+#include "mesh.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <iostream>
+
+// Uploads are split so the time budget is checked between pieces
+static const size_t UPLOAD_CHUNK_BYTES = 1 << 20;
+
+unsigned AssetLoader::defaultWorkerCount() {
+    return std::min(4u, std::max(1u, std::thread::hardware_concurrency() / 2));
+}
+
+// Workers parse at the same time, so each parser gets its share of the threads
+AssetLoader::AssetLoader(GeometryCache& cache, unsigned workerCount)
+    : cache(&cache), nextId(1), stopping(false),
+      parseThreads(std::max(1u, std::thread::hardware_concurrency() / std::max(1u, workerCount))) {
+    for (unsigned i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&AssetLoader::run, this);
+    }
+}
+
+AssetLoader::~AssetLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    for (const auto& job : jobs) {
+        if (job->geometry) cache->abortUpload(job->geometry);
+    }
+}
+
+uint64_t AssetLoader::requestMesh(const std::string& path) {
+    auto job = std::make_shared<Job>();
+    job->path = path;
+    job->quantize = cache->getQuantizePositions();
+    job->cacheDirectory = cache->getMeshCacheDirectory();
+    job->state = State::Queued;
+    job->cancelled = false;
+    job->geometry = nullptr;
+    job->uploadedBytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job->id = nextId++;
+        jobs.push_back(job);
+        queue.push_back(job);
+    }
+    wake.notify_one();
+    return job->id;
+}
+
+// A job being parsed finishes in the background and is then dropped
+void AssetLoader::cancel(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& job : jobs) {
+        if (job->id == id) job->cancelled = true;
+    }
+}
+
+bool AssetLoader::isPending(uint64_t id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& job : jobs) {
+        if (job->id == id) return !job->cancelled && job->state != State::Failed;
+    }
+    return false;
+}
+
+void AssetLoader::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping) break;
+        std::shared_ptr<Job> job = queue.front();
+        queue.pop_front();
+        if (job->cancelled) continue;
+        job->state = State::Loading;
+        lock.unlock();
+
+        State result = State::Ready;
+        std::string error;
+        try {
+            GeometryCache::prepareMesh(job->path,
+                                       [this, &job](MeshData& mesh) { Mesh::loadObj(job->path, mesh, parseThreads); },
+                                       job->quantize, job->cacheDirectory, job->prepared);
+            // Read a mapped cache file ahead here rather than fault it in during upload
+            job->prepared.cacheFile.prefetch();
+        } catch (const std::exception& e) {
+            result = State::Failed;
+            error = e.what();
+        }
+
+        lock.lock();
+        job->state = result;
+        job->error = error;
+        settled.notify_all();
+    }
+}
+
+std::vector<AssetLoader::Loaded> AssetLoader::update(size_t byteBudget, double timeBudgetMs) {
+    auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&start] {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::vector<Loaded> loaded;
+    while (true) {
+        // Jobs are picked and removed under the lock, but uploaded without
+        // it, so workers and the UI never wait for GL calls
+        std::vector<std::shared_ptr<Job>> dropped;
+        std::shared_ptr<Job> job;
+        bool budgetLeft = byteBudget > 0 && elapsedMs() < timeBudgetMs;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto it = jobs.begin(); it != jobs.end();) {
+                const std::shared_ptr<Job>& candidate = *it;
+                if (candidate->cancelled || candidate->state == State::Failed) {
+                    dropped.push_back(candidate);
+                    it = jobs.erase(it);
+                    continue;
+                }
+                // Upload in request order, so the oldest load finishes first
+                bool uploadable = candidate->state == State::Ready || candidate->state == State::Uploading;
+                if (!job && budgetLeft && uploadable) {
+                    job = candidate;
+                    job->state = State::Uploading;
+                }
+                ++it;
+            }
+        }
+        for (const auto& gone : dropped) {
+            if (gone->cancelled) {
+                if (gone->geometry) cache->abortUpload(gone->geometry);
+            } else {
+                std::cerr << "Failed to load " << gone->path << ": " << gone->error << std::endl;
+            }
+        }
+        if (!job) break;
+
+        // Only this thread touches geometry and uploadedBytes once a job is
+        // Ready; getProgress reads the latter under the lock
+        const PackedGeometry& packed = job->prepared.packed;
+        if (!job->geometry) {
+            job->geometry = cache->beginUpload(GeometryCache::meshKey(job->path), packed);
+        }
+        size_t uploadedBytes = job->uploadedBytes;
+        bool done = false;
+        while (!done && byteBudget > 0 && elapsedMs() < timeBudgetMs) {
+            size_t before = uploadedBytes;
+            done = cache->continueUpload(job->geometry, packed, uploadedBytes, std::min(byteBudget, UPLOAD_CHUNK_BYTES));
+            byteBudget -= uploadedBytes - before;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job->uploadedBytes = uploadedBytes;
+            if (done) jobs.erase(std::find(jobs.begin(), jobs.end(), job));
+        }
+        if (!done) break;
+
+        loaded.push_back({job->id, job->path, cache->finishUpload(job->geometry)});
+        job->geometry = nullptr;
+    }
+    return loaded;
+}
+
+std::vector<AssetLoader::Loaded> AssetLoader::finish() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        settled.wait(lock, [this] {
+            return std::none_of(jobs.begin(), jobs.end(), [](const std::shared_ptr<Job>& job) {
+                return !job->cancelled && (job->state == State::Queued || job->state == State::Loading);
+            });
+        });
+    }
+    return update(SIZE_MAX, std::numeric_limits<double>::infinity());
+}
+
+std::vector<AssetLoader::Progress> AssetLoader::getProgress() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Progress> progress;
+    for (const auto& job : jobs) {
+        if (job->cancelled || job->state == State::Failed) continue;
+        float uploaded = 0.0f;
+        if (job->state == State::Uploading) {
+            const PackedGeometry& packed = job->prepared.packed;
+            uploaded = (float)job->uploadedBytes / std::max<size_t>(1, packed.vertexBytes + packed.indexBytes);
+        }
+        progress.push_back({job->id, job->path, job->state, uploaded});
+    }
+    return progress;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "geometry.h"
+
+// Loads meshes on a fixed pool of worker threads and uploads them from the
+// thread owning the GL context, a bounded amount per frame. Workers do the
+// file I/O, parsing and packing (or map a current mesh cache file); update()
+// copies the packed bytes into GL buffers. Jobs can be cancelled until
+// update() hands them out.
+class AssetLoader {
+public:
+    enum class State { Queued, Loading, Ready, Uploading, Failed };
+
+    struct Progress {
+        uint64_t id;
+        std::string path;
+        State state;
+        float uploaded;     // Fraction of the bytes uploaded so far
+    };
+
+    struct Loaded {
+        uint64_t id;
+        std::string path;
+        GeometryHandle geometry; // Keeps the cache entry alive until a shape acquires it
+    };
+
+private:
+    struct Job {
+        uint64_t id;
+        std::string path;
+        bool quantize;
+        std::string cacheDirectory;
+        State state;                // Guarded by mutex
+        std::atomic<bool> cancelled;
+        std::string error;
+        PreparedMesh prepared;      // Written by the worker, read by update() once Ready
+        Geometry* geometry;         // Buffers being filled, owned by the loader until finished
+        size_t uploadedBytes;
+    };
+
+    GeometryCache* cache;
+    std::vector<std::thread> workers;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable settled;            // A job left Loading
+    std::deque<std::shared_ptr<Job>> queue;     // Waiting for a worker
+    std::vector<std::shared_ptr<Job>> jobs;     // Every unfinished job, in request order
+    uint64_t nextId;
+    bool stopping;
+    unsigned parseThreads;                      // Each worker's share of the hardware threads
+
+    void run();
+
+public:
+    // Half the hardware threads, at least one and at most four
+    static unsigned defaultWorkerCount();
+
+    AssetLoader(GeometryCache& cache, unsigned workerCount = defaultWorkerCount());
+    // Waits for loads in progress; a GL context of the cache's share group must be current
+    ~AssetLoader();
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    uint64_t requestMesh(const std::string& path);
+    void cancel(uint64_t id);
+    // True until the load is handed out by update(), fails or is cancelled
+    bool isPending(uint64_t id) const;
+    // Uploads finished loads until either budget runs out and returns the
+    // ones now complete. Call once per frame with a GL context current.
+    std::vector<Loaded> update(size_t byteBudget, double timeBudgetMs);
+    // Waits for every requested load, then uploads all of them without a
+    // budget. For loading a scene, where nothing is drawn in between.
+    std::vector<Loaded> finish();
+    std::vector<Progress> getProgress() const;
+};
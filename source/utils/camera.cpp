@@ -1,6 +1,6 @@
 #include "camera.h"
 
-Camera::Camera() : position(0.0f, 0.0f, 3.0f), rotation(0.0f), fov(45.0f), aspect(1.0f) {}
+Camera::Camera() : position(0.0f, 0.0f, 3.0f), rotation(0.0f), fov(45.0f), aspect(1.0f), nearPlane(0.1f), farPlane(100.0f) {}
 
 glm::mat4 Camera::getViewMatrix() const {
     glm::mat4 view = glm::mat4(1.0f);
@@ -12,7 +12,7 @@ glm::mat4 Camera::getViewMatrix() const {
 }
 
 glm::mat4 Camera::getProjectionMatrix() const {
-    return glm::perspective(glm::radians(fov), aspect, 0.1f, 100.0f);
+    return glm::perspective(glm::radians(fov), aspect, nearPlane, farPlane);
 }
 
 glm::vec3 Camera::getForward() const {
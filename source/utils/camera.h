@@ -8,6 +8,8 @@ private:
     glm::vec3 rotation; // Euler angles in degrees (pitch, yaw, roll)
     float fov;
     float aspect;
+    float nearPlane;
+    float farPlane;
 
 public:
     Camera();
@@ -20,5 +22,7 @@ public:
     float getFov() const { return fov; }
     void setFov(float f) { fov = f; }
     void setAspect(float a) { aspect = a; }
+    float getNear() const { return nearPlane; }
+    float getFar() const { return farPlane; }
     glm::vec3 getForward() const; // Added
 };
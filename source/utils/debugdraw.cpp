@@ -0,0 +1,144 @@
+#include "debugdraw.h"
+#include <cstring>
+#include <stdexcept>
+
+static const GLsizeiptr INITIAL_STREAM_VERTICES = 1024;
+
+DebugDraw::DebugDraw()
+    : staticVao(0), staticVbo(0), streamVao(0), streamVbo(0),
+      gridVertexCount(0), gizmoFirst(0), streamCapacity(0), streamOffset(0) {}
+
+DebugDraw::~DebugDraw() {
+    glDeleteVertexArrays(1, &staticVao);
+    glDeleteBuffers(1, &staticVbo);
+    glDeleteVertexArrays(1, &streamVao);
+    glDeleteBuffers(1, &streamVbo);
+}
+
+void DebugDraw::init() {
+    if (!glad_glGenVertexArrays) {
+        throw std::runtime_error("OpenGL not initialized");
+    }
+
+    // Grid (XZ plane, 10x10 units, 1-unit spacing)
+    std::vector<float> vertices;
+    for (int i = -5; i <= 5; ++i) {
+        vertices.insert(vertices.end(), {
+            (float)i, 0.0f, -5.0f,
+            (float)i, 0.0f, 5.0f,
+            -5.0f, 0.0f, (float)i,
+            5.0f, 0.0f, (float)i
+        });
+    }
+    gridVertexCount = vertices.size() / 3;
+    gizmoFirst = gridVertexCount;
+
+    // Gizmo (RGB axes at origin, 2 units long, with arrowheads)
+    vertices.insert(vertices.end(), {
+        // X-axis (red)
+        0.0f, 0.0f, 0.0f, 2.0f, 0.0f, 0.0f, // Main line
+        2.0f, 0.0f, 0.0f, 1.8f, 0.1f, 0.0f, // Arrowhead
+        2.0f, 0.0f, 0.0f, 1.8f, -0.1f, 0.0f,
+        2.0f, 0.0f, 0.0f, 1.8f, 0.0f, 0.1f,
+        2.0f, 0.0f, 0.0f, 1.8f, 0.0f, -0.1f,
+        // Y-axis (green)
+        0.0f, 0.0f, 0.0f, 0.0f, 2.0f, 0.0f,
+        0.0f, 2.0f, 0.0f, 0.1f, 1.8f, 0.0f,
+        0.0f, 2.0f, 0.0f, -0.1f, 1.8f, 0.0f,
+        0.0f, 2.0f, 0.0f, 0.0f, 1.8f, 0.1f,
+        0.0f, 2.0f, 0.0f, 0.0f, 1.8f, -0.1f,
+        // Z-axis (blue)
+        0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 2.0f,
+        0.0f, 0.0f, 2.0f, 0.1f, 0.0f, 1.8f,
+        0.0f, 0.0f, 2.0f, -0.1f, 0.0f, 1.8f,
+        0.0f, 0.0f, 2.0f, 0.0f, 0.1f, 1.8f,
+        0.0f, 0.0f, 2.0f, 0.0f, -0.1f, 1.8f
+    });
+
+    glGenVertexArrays(1, &staticVao);
+    glGenBuffers(1, &staticVbo);
+    glBindVertexArray(staticVao);
+    glBindBuffer(GL_ARRAY_BUFFER, staticVbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glGenVertexArrays(1, &streamVao);
+    glGenBuffers(1, &streamVbo);
+    glBindVertexArray(streamVao);
+    glBindBuffer(GL_ARRAY_BUFFER, streamVbo);
+    reserveStream(INITIAL_STREAM_VERTICES);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+}
+
+// Respecifies the stream storage; the buffer object itself is kept.
+// Expects streamVbo to be bound to GL_ARRAY_BUFFER.
+void DebugDraw::reserveStream(GLsizeiptr vertexCount) {
+    if (vertexCount > streamCapacity) {
+        streamCapacity = vertexCount;
+    }
+    glBufferData(GL_ARRAY_BUFFER, streamCapacity * sizeof(glm::vec3), nullptr, GL_STREAM_DRAW);
+    streamOffset = 0;
+}
+
+void DebugDraw::line(const glm::vec3& start, const glm::vec3& end, const glm::vec4& color, float width) {
+    lines.push_back({start, end, color, width});
+}
+
+void DebugDraw::drawGrid() {
+    glBindVertexArray(staticVao);
+    glVertexAttrib4f(COLOR_ATTRIBUTE, 0.5f, 0.5f, 0.5f, 1.0f); // Gray
+    glLineWidth(1.0f);
+    glDrawArrays(GL_LINES, 0, gridVertexCount);
+}
+
+void DebugDraw::drawGizmo() {
+    glBindVertexArray(staticVao);
+    glLineWidth(3.0f); // Thicker lines
+    glVertexAttrib4f(COLOR_ATTRIBUTE, 1.0f, 0.0f, 0.0f, 1.0f); // Red (X)
+    glDrawArrays(GL_LINES, gizmoFirst + 0, 10);
+    glVertexAttrib4f(COLOR_ATTRIBUTE, 0.0f, 1.0f, 0.0f, 1.0f); // Green (Y)
+    glDrawArrays(GL_LINES, gizmoFirst + 10, 10);
+    glVertexAttrib4f(COLOR_ATTRIBUTE, 0.0f, 0.0f, 1.0f, 1.0f); // Blue (Z)
+    glDrawArrays(GL_LINES, gizmoFirst + 20, 10);
+    glLineWidth(1.0f);
+}
+
+void DebugDraw::flush() {
+    if (lines.empty()) {
+        return;
+    }
+
+    GLsizeiptr count = lines.size() * 2;
+    scratch.clear();
+    for (const Line& l : lines) {
+        scratch.push_back(l.start);
+        scratch.push_back(l.end);
+    }
+
+    glBindVertexArray(streamVao);
+    glBindBuffer(GL_ARRAY_BUFFER, streamVbo);
+    if (streamOffset + count > streamCapacity) {
+        // Orphan the old storage instead of waiting for the GPU to finish with it
+        reserveStream(count);
+    }
+    void* dst = glMapBufferRange(GL_ARRAY_BUFFER, streamOffset * sizeof(glm::vec3), count * sizeof(glm::vec3),
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (dst) {
+        std::memcpy(dst, scratch.data(), count * sizeof(glm::vec3));
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+
+        for (size_t i = 0; i < lines.size(); ++i) {
+            glVertexAttrib4fv(COLOR_ATTRIBUTE, &lines[i].color[0]);
+            glLineWidth(lines[i].width);
+            glDrawArrays(GL_LINES, streamOffset + i * 2, 2);
+        }
+        glLineWidth(1.0f);
+        streamOffset += count;
+    }
+
+    glBindVertexArray(0);
+    lines.clear();
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Retained debug geometry for one GL context.
+// The grid and gizmo are uploaded once; per-frame lines stream through a
+// single persistent buffer, so drawing never creates or deletes GL objects.
+// Colors are set as the current value of COLOR_ATTRIBUTE, context state
+// rather than a uniform of the shared program.
+class DebugDraw {
+private:
+    struct Line {
+        glm::vec3 start;
+        glm::vec3 end;
+        glm::vec4 color;
+        float width;
+    };
+
+    GLuint staticVao, staticVbo;
+    GLuint streamVao, streamVbo;
+    GLsizei gridVertexCount;
+    GLint gizmoFirst;
+    GLsizeiptr streamCapacity; // In vertices
+    GLsizeiptr streamOffset;   // In vertices
+    std::vector<Line> lines;
+    std::vector<glm::vec3> scratch;
+
+    void reserveStream(GLsizeiptr vertexCount);
+
+public:
+    static const GLuint COLOR_ATTRIBUTE = 4;
+
+    DebugDraw();
+    ~DebugDraw();
+    void init();
+    void line(const glm::vec3& start, const glm::vec3& end, const glm::vec4& color, float width = 1.0f);
+    void drawGrid();
+    void drawGizmo();
+    void flush();
+};
@@ -0,0 +1,133 @@
+#pragma once
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <iterator>
+#include <cstdint>
+#include <unordered_set>
+
+// Structure-of-arrays storage for one entity type. Every component lives in
+// its own array, listed by the derived store's columns(); entry i of each
+// array belongs to the entity whose view is views[i], and i is its dense id.
+// Erasing keeps the order, so ids stay dense and follow insertion order.
+// Views are the thin objects editors hold on to; they are owned by the
+// store, which updates their store pointer and id whenever either changes.
+// Stores whose components hold ids define idsRemapped() and appended() to
+// fix them up.
+template<typename Derived, typename View>
+class EntityStore {
+public:
+    static constexpr uint32_t NO_ID = 0xffffffffu;
+
+protected:
+    friend View;
+    std::vector<View*> views;
+
+    // newIds maps each old id to its new one, NO_ID when erased
+    void idsRemapped(const std::vector<uint32_t>&) {}
+    // Rows from first on were moved from other, where their ids started at 0
+    void appended(Derived&, uint32_t) {}
+
+    template<typename F>
+    void forEachColumn(F f) {
+        std::apply([&f](auto&... column) { (f(column), ...); }, static_cast<Derived*>(this)->columns());
+    }
+
+    template<typename Tuple, size_t... I>
+    static void appendColumns(Tuple to, Tuple from, std::index_sequence<I...>) {
+        ((std::get<I>(to).insert(std::get<I>(to).end(), std::make_move_iterator(std::get<I>(from).begin()),
+                                 std::make_move_iterator(std::get<I>(from).end())),
+          std::get<I>(from).clear()), ...);
+    }
+
+    template<typename T>
+    static void compact(std::vector<T>& column, const std::vector<uint8_t>& keep) {
+        size_t out = 0;
+        for (size_t i = 0; i < column.size(); ++i) {
+            if (!keep[i]) continue;
+            if (out != i) column[out] = std::move(column[i]);
+            ++out;
+        }
+        column.resize(out);
+    }
+
+    // Appends a row of value-initialized components for a new view; views call this from their constructor
+    uint32_t add(View* view) {
+        forEachColumn([](auto& column) { column.emplace_back(); });
+        views.push_back(view);
+        return views.size() - 1;
+    }
+
+public:
+    EntityStore() {}
+    // Components are destroyed with the derived store
+    ~EntityStore() {
+        for (View* view : views) {
+            delete view;
+        }
+    }
+    EntityStore(const EntityStore&) = delete;
+    EntityStore& operator=(const EntityStore&) = delete;
+
+    uint32_t size() const { return views.size(); }
+    bool empty() const { return views.empty(); }
+    const std::vector<View*>& getViews() const { return views; }
+
+    void reserve(size_t count) {
+        forEachColumn([count](auto& column) { column.reserve(count); });
+        views.reserve(count);
+    }
+
+    // Moves every entity of other to the end of this store, keeping their order
+    void append(Derived& other) {
+        Derived& self = static_cast<Derived&>(*this);
+        uint32_t first = views.size();
+        auto columns = self.columns();
+        appendColumns(columns, other.columns(), std::make_index_sequence<std::tuple_size<decltype(columns)>::value>());
+        views.insert(views.end(), other.views.begin(), other.views.end());
+        other.views.clear();
+        for (uint32_t i = first; i < views.size(); ++i) {
+            views[i]->store = &self;
+            views[i]->id = i;
+        }
+        self.appended(other, first);
+    }
+
+    // Deletes the listed views and their components; later ids shift down.
+    // Pointers not in this store, or listed twice, are ignored.
+    void erase(const std::vector<View*>& removed) {
+        if (removed.empty()) return;
+        std::unordered_set<const View*> doomed(removed.begin(), removed.end());
+        std::vector<uint8_t> keep(views.size(), 1);
+        bool erased = false;
+        for (size_t i = 0; i < views.size(); ++i) {
+            if (doomed.count(views[i])) {
+                keep[i] = 0;
+                erased = true;
+            }
+        }
+        if (!erased) return;
+
+        for (size_t i = 0; i < views.size(); ++i) {
+            if (!keep[i]) delete views[i];
+        }
+        std::vector<uint32_t> newIds(views.size(), NO_ID);
+        for (uint32_t i = 0, next = 0; i < views.size(); ++i) {
+            if (keep[i]) newIds[i] = next++;
+        }
+        forEachColumn([&keep](auto& column) { compact(column, keep); });
+        compact(views, keep);
+        for (uint32_t i = 0; i < views.size(); ++i) {
+            views[i]->id = i;
+        }
+        static_cast<Derived*>(this)->idsRemapped(newIds);
+    }
+
+    void clear() {
+        for (View* view : views) {
+            delete view;
+        }
+        views.clear();
+        forEachColumn([](auto& column) { column.clear(); });
+    }
+};
@@ -0,0 +1,94 @@
+#include "framereadback.h"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+FrameReadback::FrameReadback() : next(0) {}
+
+FrameReadback::~FrameReadback() {
+    for (Capture& capture : ring) {
+        if (capture.fence) glDeleteSync(capture.fence);
+        glDeleteBuffers(1, &capture.pbo);
+    }
+}
+
+void FrameReadback::init() {
+    if (!glad_glGenVertexArrays) {
+        throw std::runtime_error("OpenGL not initialized");
+    }
+
+    ring.resize(RING_SIZE);
+    for (Capture& capture : ring) {
+        glGenBuffers(1, &capture.pbo);
+        capture.fence = nullptr;
+        capture.width = 0;
+        capture.height = 0;
+    }
+}
+
+void FrameReadback::capture(int width, int height, const std::string& path) {
+    Capture& slot = ring[next];
+    if (slot.fence) {
+        write(slot); // Ring is full; the oldest capture has to land first
+    }
+    next = (next + 1) % ring.size();
+
+    slot.width = width;
+    slot.height = height;
+    slot.path = path;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, nullptr, GL_STREAM_READ);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void FrameReadback::poll() {
+    // Oldest first, so files appear in frame order
+    for (size_t i = 0; i < ring.size(); ++i) {
+        Capture& capture = ring[(next + i) % ring.size()];
+        if (!capture.fence) continue;
+        if (glClientWaitSync(capture.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED) break;
+        write(capture);
+    }
+}
+
+void FrameReadback::finish() {
+    for (size_t i = 0; i < ring.size(); ++i) {
+        Capture& capture = ring[(next + i) % ring.size()];
+        if (capture.fence) write(capture);
+    }
+}
+
+// Blocks on the capture's fence if it has not signaled yet
+void FrameReadback::write(Capture& capture) {
+    glClientWaitSync(capture.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    glDeleteSync(capture.fence);
+    capture.fence = nullptr;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, capture.pbo);
+    const unsigned char* pixels = (const unsigned char*)glMapBufferRange(
+        GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)capture.width * capture.height * 4, GL_MAP_READ_BIT);
+    if (pixels) {
+        std::ofstream file(capture.path, std::ios::binary);
+        if (file) {
+            file << "P6\n" << capture.width << " " << capture.height << "\n255\n";
+            // GL rows run bottom-up; PPM rows run top-down and carry no alpha
+            row.resize(capture.width * 3);
+            for (int y = capture.height - 1; y >= 0; --y) {
+                const unsigned char* src = pixels + (size_t)y * capture.width * 4;
+                for (int x = 0; x < capture.width; ++x) {
+                    row[x * 3 + 0] = src[x * 4 + 0];
+                    row[x * 3 + 1] = src[x * 4 + 1];
+                    row[x * 3 + 2] = src[x * 4 + 2];
+                }
+                file.write((const char*)row.data(), row.size());
+            }
+        } else {
+            std::cerr << "Failed to write frame: " << capture.path << std::endl;
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
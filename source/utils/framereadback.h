@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+// Asynchronous color readback into a small ring of pixel buffers.
+// capture() only queues the copy; the pixels are written out as PPM files
+// by poll() once the GPU has finished, a few frames later, so reading
+// back never stalls the frame that produced them.
+class FrameReadback {
+private:
+    struct Capture {
+        GLuint pbo;
+        GLsync fence;           // Null while the slot is free
+        int width, height;
+        std::string path;
+    };
+
+    std::vector<Capture> ring;
+    size_t next;
+    std::vector<unsigned char> row;
+
+    void write(Capture& capture);
+
+public:
+    static const int RING_SIZE = 3;
+
+    FrameReadback();
+    ~FrameReadback();
+    void init();
+    // Queues a copy of the bound read framebuffer; waits only when every slot is still in flight
+    void capture(int width, int height, const std::string& path);
+    // Writes out every capture the GPU has finished
+    void poll();
+    // Writes out all outstanding captures
+    void finish();
+};
@@ -0,0 +1,34 @@
+#include "frameuniforms.h"
+#include <cstring>
+#include <stdexcept>
+
+FrameUniformBuffer::FrameUniformBuffer() : ubo(0), last(), valid(false) {}
+
+FrameUniformBuffer::~FrameUniformBuffer() {
+    glDeleteBuffers(1, &ubo);
+}
+
+void FrameUniformBuffer::init() {
+    if (!glad_glGenVertexArrays) {
+        throw std::runtime_error("OpenGL not initialized");
+    }
+
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Skips the upload when the camera has not moved since the last frame.
+void FrameUniformBuffer::update(const FrameUniforms& frame) {
+    if (valid && std::memcmp(&frame, &last, sizeof(FrameUniforms)) == 0) return;
+    last = frame;
+    valid = true;
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &frame);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FrameUniformBuffer::bind() const {
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, ubo);
+}
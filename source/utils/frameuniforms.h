@@ -0,0 +1,30 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Per-frame camera data in std140 layout, matching the "Frame" block
+// declared by every renderer program.
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec4 cameraPosition;
+};
+
+// Uniform buffer holding FrameUniforms at a fixed binding point, so any
+// program that declares the block reads it without per-program uploads.
+class FrameUniformBuffer {
+private:
+    GLuint ubo;
+    FrameUniforms last;
+    bool valid;
+
+public:
+    static const GLuint BINDING = 0;
+
+    FrameUniformBuffer();
+    ~FrameUniformBuffer();
+    void init();
+    void update(const FrameUniforms& frame);
+    void bind() const;
+};
@@ -0,0 +1,81 @@
+#include "frustum.h"
+#include <algorithm>
+#include <cmath>
+
+Bounds Bounds::fromPoints(const float* positions, size_t count, size_t stride) {
+    Bounds bounds;
+    if (count == 0) {
+        bounds.min = bounds.max = bounds.center = glm::vec3(0.0f);
+        bounds.radius = 0.0f;
+        return bounds;
+    }
+
+    bounds.min = bounds.max = glm::vec3(positions[0], positions[1], positions[2]);
+    for (size_t i = 1; i < count; ++i) {
+        glm::vec3 p(positions[i * stride], positions[i * stride + 1], positions[i * stride + 2]);
+        bounds.min = glm::min(bounds.min, p);
+        bounds.max = glm::max(bounds.max, p);
+    }
+    bounds.center = (bounds.min + bounds.max) * 0.5f;
+    float radius2 = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 p(positions[i * stride], positions[i * stride + 1], positions[i * stride + 2]);
+        glm::vec3 d = p - bounds.center;
+        radius2 = std::max(radius2, glm::dot(d, d));
+    }
+    bounds.radius = std::sqrt(radius2);
+    return bounds;
+}
+
+// Box via Arvo's method; sphere scaled by the largest axis scale.
+Bounds Bounds::transformed(const glm::mat4& model) const {
+    Bounds result;
+    glm::vec3 translation(model[3]);
+    result.min = result.max = translation;
+    for (int col = 0; col < 3; ++col) {
+        for (int row = 0; row < 3; ++row) {
+            float a = model[col][row] * min[col];
+            float b = model[col][row] * max[col];
+            result.min[row] += std::min(a, b);
+            result.max[row] += std::max(a, b);
+        }
+    }
+
+    result.center = glm::vec3(model * glm::vec4(center, 1.0f));
+    float scale2 = std::max({glm::dot(glm::vec3(model[0]), glm::vec3(model[0])),
+                             glm::dot(glm::vec3(model[1]), glm::vec3(model[1])),
+                             glm::dot(glm::vec3(model[2]), glm::vec3(model[2]))});
+    result.radius = radius * std::sqrt(scale2);
+    return result;
+}
+
+Frustum::Frustum(const glm::mat4& m) {
+    for (int i = 0; i < 3; ++i) {
+        glm::vec4 row(m[0][i], m[1][i], m[2][i], m[3][i]);
+        glm::vec4 w(m[0][3], m[1][3], m[2][3], m[3][3]);
+        planes[i * 2] = w + row;
+        planes[i * 2 + 1] = w - row;
+    }
+    for (glm::vec4& plane : planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+// Conservative: may keep boxes that straddle two planes near a frustum corner.
+bool Frustum::intersects(const Bounds& bounds) const {
+    bool sphereInside = true;
+    for (const glm::vec4& plane : planes) {
+        float distance = glm::dot(glm::vec3(plane), bounds.center) + plane.w;
+        if (distance < -bounds.radius) return false;
+        if (distance < bounds.radius) sphereInside = false;
+    }
+    if (sphereInside) return true;
+
+    for (const glm::vec4& plane : planes) {
+        glm::vec3 positive(plane.x >= 0.0f ? bounds.max.x : bounds.min.x,
+                           plane.y >= 0.0f ? bounds.max.y : bounds.min.y,
+                           plane.z >= 0.0f ? bounds.max.z : bounds.min.z);
+        if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) return false;
+    }
+    return true;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <glm/glm.hpp>
+
+// Axis-aligned box plus enclosing sphere, in local or world space.
+struct Bounds {
+    glm::vec3 min;
+    glm::vec3 max;
+    glm::vec3 center;
+    float radius;
+
+    static Bounds fromPoints(const float* positions, size_t count, size_t stride = 3);
+    Bounds transformed(const glm::mat4& model) const;
+};
+
+// Six planes extracted from a view-projection matrix, normals pointing inward.
+class Frustum {
+private:
+    glm::vec4 planes[6];
+
+public:
+    Frustum() {}
+    explicit Frustum(const glm::mat4& viewProjection);
+    bool intersects(const Bounds& bounds) const;
+};
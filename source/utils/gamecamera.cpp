@@ -2,9 +2,14 @@
 #include "gamecamera.h"
 #include <glm/gtc/matrix_transform.hpp>
 
-GameCamera::GameCamera(const std::string& name) : name(name), position(0.0f, 0.0f, 3.0f), rotation(0.0f), fov(45.0f) {}
+GameCamera::GameCamera(GameCameraStore& store, const std::string& name) : name(name), store(&store), id(store.add(this)) {
+    store.positions[id] = glm::vec3(0.0f, 0.0f, 3.0f);
+    store.rotations[id] = glm::vec3(0.0f);
+    store.fovs[id] = 45.0f;
+}
 
 glm::vec3 GameCamera::getForward() const {
+    glm::vec3 rotation = store->rotations[id];
     glm::vec3 forward = glm::vec3(0.0f, 0.0f, -1.0f);
     glm::mat4 rot = glm::mat4(1.0f);
     rot = glm::rotate(rot, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f)); // Yaw
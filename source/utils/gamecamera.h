@@ -1,22 +1,40 @@
 #pragma once
 #include <glm/glm.hpp>
 #include <string>
+#include "entitystore.h"
 
+class GameCamera;
+
+// Components of every game camera, one array each
+class GameCameraStore : public EntityStore<GameCameraStore, GameCamera> {
+public:
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> rotations;   // Euler angles in degrees (pitch, yaw, roll)
+    std::vector<float> fovs;
+
+    auto columns() { return std::tie(positions, rotations, fovs); }
+};
+
+// Thin view of one entry of a GameCameraStore, owned by the store
 class GameCamera {
 private:
+    friend class EntityStore<GameCameraStore, GameCamera>;
     std::string name;
-    glm::vec3 position;
-    glm::vec3 rotation; // Euler angles in degrees (pitch, yaw, roll)
-    float fov;
+    GameCameraStore* store;
+    uint32_t id;
 
 public:
-    GameCamera(const std::string& name);
+    // Adds a game camera with default components to store
+    GameCamera(GameCameraStore& store, const std::string& name);
+    GameCamera(const GameCamera&) = delete;
+    GameCamera& operator=(const GameCamera&) = delete;
     std::string getName() const { return name; }
-    glm::vec3 getPosition() const { return position; }
-    void setPosition(const glm::vec3& pos) { position = pos; }
-    glm::vec3 getRotation() const { return rotation; }
-    void setRotation(const glm::vec3& rot) { rotation = rot; }
-    float getFov() const { return fov; }
-    void setFov(float f) { fov = f; }
+    uint32_t getId() const { return id; }
+    glm::vec3 getPosition() const { return store->positions[id]; }
+    void setPosition(const glm::vec3& pos) { store->positions[id] = pos; }
+    glm::vec3 getRotation() const { return store->rotations[id]; }
+    void setRotation(const glm::vec3& rot) { store->rotations[id] = rot; }
+    float getFov() const { return store->fovs[id]; }
+    void setFov(float f) { store->fovs[id] = f; }
     glm::vec3 getForward() const;
 };
@@ -0,0 +1,289 @@
+#include "geometry.h"
+#include "shape.h"
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+
+GeometryHandle::GeometryHandle(Geometry* geometry) : geometry(geometry) {
+    if (geometry) ++geometry->refCount;
+}
+
+GeometryHandle::GeometryHandle(const GeometryHandle& other) : GeometryHandle(other.geometry) {}
+
+GeometryHandle::GeometryHandle(GeometryHandle&& other) noexcept : geometry(other.geometry) {
+    other.geometry = nullptr;
+}
+
+GeometryHandle& GeometryHandle::operator=(GeometryHandle other) {
+    std::swap(geometry, other.geometry);
+    return *this;
+}
+
+GeometryHandle::~GeometryHandle() {
+    reset();
+}
+
+void GeometryHandle::reset() {
+    if (geometry) {
+        geometry->owner->release(geometry);
+        geometry = nullptr;
+    }
+}
+
+GeometryCache::~GeometryCache() {
+    for (auto& entry : entries) {
+        Geometry* geometry = entry.second;
+        glDeleteBuffers(1, &geometry->vbo);
+        glDeleteBuffers(1, &geometry->ebo);
+        delete geometry;
+    }
+}
+
+GeometryHandle GeometryCache::acquire(const std::string& key, const Builder& build) {
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        return GeometryHandle(it->second);
+    }
+
+    if (!glad_glGenVertexArrays) {
+        throw std::runtime_error("OpenGL not initialized");
+    }
+
+    MeshData mesh;
+    build(mesh);
+    if (mesh.positions.empty() || mesh.indices.empty()) {
+        throw std::runtime_error("No vertices or indices for geometry: " + key);
+    }
+
+    PackedGeometry packed;
+    std::vector<unsigned char> storage;
+    pack(mesh, quantizePositions, packed, storage);
+    return create(key, packed);
+}
+
+GeometryHandle GeometryCache::acquirePrimitive(const std::string& type) {
+    return acquire("primitive:" + type, [&type](MeshData& mesh) {
+        Shape::buildPrimitive(type, mesh);
+    });
+}
+
+GeometryHandle GeometryCache::acquireMesh(const std::string& path, const Builder& load) {
+    std::string key = meshKey(path);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        return GeometryHandle(it->second);
+    }
+
+    if (!glad_glGenVertexArrays) {
+        throw std::runtime_error("OpenGL not initialized");
+    }
+
+    PreparedMesh prepared;
+    prepareMesh(path, load, quantizePositions, meshCacheDirectory, prepared);
+    return create(key, prepared.packed);
+}
+
+void GeometryCache::prepareMesh(const std::string& path, const Builder& load, bool quantize,
+                                const std::string& cacheDirectory, PreparedMesh& prepared) {
+    // A current cache file is uploaded straight from its mapping
+    std::string cachePath = MeshCacheFile::pathFor(path, cacheDirectory);
+    if (prepared.cacheFile.open(cachePath, path, quantize ? GL_SHORT : GL_FLOAT, prepared.packed)) {
+        return;
+    }
+
+    MeshData mesh;
+    load(mesh);
+    if (mesh.positions.empty() || mesh.indices.empty()) {
+        throw std::runtime_error("No vertices or indices for geometry: " + meshKey(path));
+    }
+
+    pack(mesh, quantize, prepared.packed, prepared.storage);
+    MeshCacheFile::write(cachePath, path, prepared.packed);
+}
+
+GeometryHandle GeometryCache::find(const std::string& key) {
+    auto it = entries.find(key);
+    return it != entries.end() ? GeometryHandle(it->second) : GeometryHandle();
+}
+
+void GeometryCache::release(Geometry* geometry) {
+    if (--geometry->refCount > 0) return;
+    entries.erase(geometry->key);
+    destroy(geometry);
+}
+
+void GeometryCache::destroy(Geometry* geometry) {
+    glDeleteBuffers(1, &geometry->vbo);
+    glDeleteBuffers(1, &geometry->ebo);
+    delete geometry;
+}
+
+// Stored positions are normalized over the bounds; this maps them back
+static glm::mat4 dequantization(const Bounds& bounds) {
+    glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+    glm::vec3 halfExtent = (bounds.max - bounds.min) * 0.5f;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (halfExtent[axis] <= 0.0f) halfExtent[axis] = 1.0f; // Flat axis, every vertex stores 0
+    }
+    return glm::scale(glm::translate(glm::mat4(1.0f), center), halfExtent);
+}
+
+void GeometryCache::pack(const MeshData& mesh, bool quantize, PackedGeometry& packed, std::vector<unsigned char>& storage) {
+    size_t vertexCount = mesh.vertexCount();
+    packed.vertexCount = vertexCount;
+    packed.indexCount = mesh.indices.size();
+    packed.bounds = Bounds::fromPoints(mesh.positions.data(), vertexCount);
+    packed.submeshes = mesh.submeshes;
+    if (packed.submeshes.empty()) {
+        packed.submeshes.push_back({0, (uint32_t)mesh.indices.size()});
+    }
+
+    // Interleave the streams so one vertex is one contiguous fetch. Positions
+    // are stored as normalized int16 within the bounds (4 components keep
+    // vertices 4-byte aligned), normals as 10-10-10-2 and UVs as half floats.
+    packed.positionType = quantize ? GL_SHORT : GL_FLOAT;
+    GLsizei stride = quantize ? 4 * sizeof(int16_t) : 3 * sizeof(float);
+    packed.normalOffset = mesh.hasNormals() ? stride : -1;
+    if (mesh.hasNormals()) stride += sizeof(uint32_t);
+    packed.uvOffset = mesh.hasUvs() ? stride : -1;
+    if (mesh.hasUvs()) stride += sizeof(uint32_t);
+    packed.stride = stride;
+    packed.indexType = vertexCount <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    packed.vertexBytes = vertexCount * stride;
+    packed.indexBytes = mesh.indices.size() * (packed.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t));
+
+    // Both streams share one allocation; vertices come first, so indices stay 4-byte aligned
+    storage.resize(packed.vertexBytes + packed.indexBytes);
+    glm::mat4 quantization = glm::inverse(dequantization(packed.bounds));
+    for (size_t v = 0; v < vertexCount; ++v) {
+        unsigned char* out = &storage[v * stride];
+        const float* position = &mesh.positions[v * 3];
+        if (quantize) {
+            glm::vec3 normalized = glm::clamp(glm::vec3(quantization * glm::vec4(position[0], position[1], position[2], 1.0f)), -1.0f, 1.0f);
+            int16_t values[4] = {0, 0, 0, 0};
+            for (int axis = 0; axis < 3; ++axis) {
+                values[axis] = (int16_t)std::lround(normalized[axis] * 32767.0f);
+            }
+            std::memcpy(out, values, sizeof(values));
+        } else {
+            std::memcpy(out, position, 3 * sizeof(float));
+        }
+        if (mesh.hasNormals()) {
+            const float* normal = &mesh.normals[v * 3];
+            uint32_t value = glm::packSnorm3x10_1x2(glm::vec4(normal[0], normal[1], normal[2], 0.0f));
+            std::memcpy(out + packed.normalOffset, &value, sizeof(value));
+        }
+        if (mesh.hasUvs()) {
+            uint32_t value = glm::packHalf2x16(glm::vec2(mesh.uvs[v * 2], mesh.uvs[v * 2 + 1]));
+            std::memcpy(out + packed.uvOffset, &value, sizeof(value));
+        }
+    }
+
+    unsigned char* indexOut = storage.data() + packed.vertexBytes;
+    if (packed.indexType == GL_UNSIGNED_SHORT) {
+        for (size_t i = 0; i < mesh.indices.size(); ++i) {
+            uint16_t index = (uint16_t)mesh.indices[i];
+            std::memcpy(indexOut + i * sizeof(uint16_t), &index, sizeof(index));
+        }
+    } else {
+        std::memcpy(indexOut, mesh.indices.data(), packed.indexBytes);
+    }
+
+    packed.vertexData = storage.data();
+    packed.indexData = indexOut;
+}
+
+GeometryHandle GeometryCache::create(const std::string& key, const PackedGeometry& packed) {
+    Geometry* geometry = beginUpload(key, packed);
+    size_t uploadedBytes = 0;
+    continueUpload(geometry, packed, uploadedBytes, packed.vertexBytes + packed.indexBytes);
+    return finishUpload(geometry);
+}
+
+Geometry* GeometryCache::beginUpload(const std::string& key, const PackedGeometry& packed) {
+    Geometry* geometry = new Geometry{key, nextId++, 0, 0, packed.vertexCount, packed.indexCount, packed.indexType,
+                                      packed.positionType, packed.stride, packed.normalOffset, packed.uvOffset,
+                                      packed.positionType == GL_SHORT ? dequantization(packed.bounds) : glm::mat4(1.0f),
+                                      0, this, packed.bounds, packed.submeshes};
+
+    glGenBuffers(1, &geometry->vbo);
+    glGenBuffers(1, &geometry->ebo);
+
+    // Upload through the copy target: the element binding belongs to whatever VAO is bound
+    glBindBuffer(GL_COPY_WRITE_BUFFER, geometry->vbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, packed.vertexBytes, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, geometry->ebo);
+    glBufferData(GL_COPY_WRITE_BUFFER, packed.indexBytes, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return geometry;
+}
+
+// uploadedBytes counts through the vertex bytes, then the index bytes
+bool GeometryCache::continueUpload(Geometry* geometry, const PackedGeometry& packed, size_t& uploadedBytes, size_t budget) {
+    size_t totalBytes = packed.vertexBytes + packed.indexBytes;
+    while (budget > 0 && uploadedBytes < totalBytes) {
+        bool vertices = uploadedBytes < packed.vertexBytes;
+        size_t offset = vertices ? uploadedBytes : uploadedBytes - packed.vertexBytes;
+        size_t remaining = (vertices ? packed.vertexBytes : packed.indexBytes) - offset;
+        size_t chunk = std::min(remaining, budget);
+        const unsigned char* source = static_cast<const unsigned char*>(vertices ? packed.vertexData : packed.indexData);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vertices ? geometry->vbo : geometry->ebo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, chunk, source + offset);
+        uploadedBytes += chunk;
+        budget -= chunk;
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return uploadedBytes >= totalBytes;
+}
+
+// Another load of the same key may have finished first; that one wins
+GeometryHandle GeometryCache::finishUpload(Geometry* geometry) {
+    auto it = entries.find(geometry->key);
+    if (it != entries.end()) {
+        destroy(geometry);
+        return GeometryHandle(it->second);
+    }
+    entries[geometry->key] = geometry;
+    return GeometryHandle(geometry);
+}
+
+void GeometryCache::abortUpload(Geometry* geometry) {
+    destroy(geometry);
+}
+
+// Builds a vertex array for the current context describing this geometry's buffers.
+GLuint Geometry::createVao() const {
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    if (positionType == GL_SHORT) {
+        glVertexAttribPointer(0, 4, GL_SHORT, GL_TRUE, stride, (void*)0);
+    } else {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    }
+    glEnableVertexAttribArray(0);
+    if (normalOffset >= 0) {
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)(intptr_t)normalOffset);
+        glEnableVertexAttribArray(1);
+    }
+    if (uvOffset >= 0) {
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)(intptr_t)uvOffset);
+        glEnableVertexAttribArray(2);
+    }
+    glBindVertexArray(0);
+    return vao;
+}
+
+// Different spellings of one file ("a/../b.obj", "./b.obj") map to one entry.
+std::string GeometryCache::canonicalPath(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+    return ec ? path : canonical.string();
+}
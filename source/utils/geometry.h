@@ -0,0 +1,128 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <glad/glad.h>
+#include "frustum.h"
+#include "meshdata.h"
+#include "meshcachefile.h"
+
+class GeometryCache;
+
+// GPU buffers for one primitive type or mesh file, shared by every shape using it.
+// Buffers are shared across contexts; vertex array objects are not, so each
+// renderer builds its own with createVao().
+struct Geometry {
+    std::string key;
+    uint64_t id;        // Unique for the cache's lifetime, never reused
+    GLuint vbo, ebo;
+    GLsizei vertexCount;
+    GLsizei indexCount;
+    GLenum indexType;   // GL_UNSIGNED_SHORT when every index fits, else GL_UNSIGNED_INT
+    GLenum positionType; // GL_SHORT for positions quantized within bounds, else GL_FLOAT
+    GLsizei stride;     // Bytes per interleaved vertex
+    GLint normalOffset; // Byte offsets within a vertex, -1 when the stream is absent
+    GLint uvOffset;
+    glm::mat4 dequantize; // Maps stored positions back to local space; folded into the instance matrix
+    int refCount;
+    GeometryCache* owner;
+    Bounds bounds;      // Local space, computed at upload
+    std::vector<Submesh> submeshes;
+
+    GLuint createVao() const;
+};
+
+// Vertex and index bytes already in the GPU layout, plus the layout itself.
+// The bytes are borrowed: from a packing buffer or a mapped mesh cache file.
+struct PackedGeometry {
+    GLsizei vertexCount;
+    GLsizei indexCount;
+    GLenum indexType;
+    GLenum positionType;
+    GLsizei stride;
+    GLint normalOffset;
+    GLint uvOffset;
+    Bounds bounds;
+    std::vector<Submesh> submeshes;
+    const void* vertexData;
+    size_t vertexBytes;
+    const void* indexData;
+    size_t indexBytes;
+};
+
+// A mesh loaded and packed on the CPU, ready for upload. The bytes are
+// mapped from the cache file when it was current, else held in storage.
+struct PreparedMesh {
+    MeshCacheFile cacheFile;
+    std::vector<unsigned char> storage;
+    PackedGeometry packed;
+};
+
+// Counted reference to a cached Geometry; the buffers are freed with the last handle.
+class GeometryHandle {
+private:
+    Geometry* geometry;
+
+public:
+    GeometryHandle() : geometry(nullptr) {}
+    explicit GeometryHandle(Geometry* geometry);
+    GeometryHandle(const GeometryHandle& other);
+    GeometryHandle(GeometryHandle&& other) noexcept;
+    GeometryHandle& operator=(GeometryHandle other);
+    ~GeometryHandle();
+    void reset();
+    Geometry* get() const { return geometry; }
+    Geometry* operator->() const { return geometry; }
+    explicit operator bool() const { return geometry != nullptr; }
+};
+
+// Registry of uploaded geometry keyed by primitive type or canonical mesh path.
+class GeometryCache {
+public:
+    typedef std::function<void(MeshData& mesh)> Builder;
+
+private:
+    std::unordered_map<std::string, Geometry*> entries;
+    uint64_t nextId;
+    bool quantizePositions;
+    std::string meshCacheDirectory;
+    GeometryHandle create(const std::string& key, const PackedGeometry& packed);
+    void destroy(Geometry* geometry);
+
+public:
+    GeometryCache() : nextId(1), quantizePositions(true) {}
+    ~GeometryCache();
+    GeometryHandle acquire(const std::string& key, const Builder& build);
+    GeometryHandle acquirePrimitive(const std::string& type);
+    // Uses the packed mesh cache when it matches the source file, else loads and refreshes it
+    GeometryHandle acquireMesh(const std::string& path, const Builder& load);
+    void release(Geometry* geometry);
+    size_t size() const { return entries.size(); }
+    // Applies to geometry uploaded afterwards
+    void setQuantizePositions(bool quantize) { quantizePositions = quantize; }
+    bool getQuantizePositions() const { return quantizePositions; }
+    // Where packed copies of loaded meshes are kept; empty puts them beside the source file
+    void setMeshCacheDirectory(const std::string& directory) { meshCacheDirectory = directory; }
+    const std::string& getMeshCacheDirectory() const { return meshCacheDirectory; }
+    // The cached geometry for key, or an empty handle
+    GeometryHandle find(const std::string& key);
+
+    // Uploads spread over several frames: beginUpload allocates the buffers,
+    // continueUpload copies at most budget bytes and returns true once all
+    // are in, then finishUpload publishes the geometry under its key.
+    // packed's bytes must stay valid until then; abortUpload frees them instead.
+    Geometry* beginUpload(const std::string& key, const PackedGeometry& packed);
+    bool continueUpload(Geometry* geometry, const PackedGeometry& packed, size_t& uploadedBytes, size_t budget);
+    GeometryHandle finishUpload(Geometry* geometry);
+    void abortUpload(Geometry* geometry);
+
+    // The CPU half of acquireMesh, touching no GL state so it may run on any thread
+    static void prepareMesh(const std::string& path, const Builder& load, bool quantize,
+                            const std::string& cacheDirectory, PreparedMesh& prepared);
+    static std::string meshKey(const std::string& path) { return "mesh:" + canonicalPath(path); }
+    // Converts mesh into the compact GPU layout; packed points into storage
+    static void pack(const MeshData& mesh, bool quantize, PackedGeometry& packed, std::vector<unsigned char>& storage);
+    static std::string canonicalPath(const std::string& path);
+};
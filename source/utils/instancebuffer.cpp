@@ -0,0 +1,137 @@
+#include "instancebuffer.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+static const size_t INITIAL_SLOTS = 256;
+static const uint32_t MAX_UPLOAD_GAP = 8; // Clean slots re-sent to merge two dirty runs
+
+InstanceBuffer::InstanceBuffer()
+    : dataBuffer(0), dataTexture(0), dataCapacity(0), uploadedSlots(0) {}
+
+InstanceBuffer::~InstanceBuffer() {
+    glDeleteTextures(1, &dataTexture);
+    glDeleteBuffers(1, &dataBuffer);
+}
+
+void InstanceBuffer::init() {
+    if (!glad_glGenVertexArrays) {
+        throw std::runtime_error("OpenGL not initialized");
+    }
+
+    dataCapacity = INITIAL_SLOTS;
+    glGenBuffers(1, &dataBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, dataBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, dataCapacity * sizeof(InstanceData), nullptr, GL_DYNAMIC_DRAW);
+    glGenTextures(1, &dataTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, dataTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, dataBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void InstanceBuffer::resize(size_t count) {
+    size_t oldCount = mirror.size();
+    if (count == oldCount) return;
+    mirror.resize(count);
+    dirtyFlags.resize(count, 0);
+
+    if (count > dataCapacity) {
+        while (dataCapacity < count) dataCapacity *= 2;
+        glBindBuffer(GL_TEXTURE_BUFFER, dataBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, dataCapacity * sizeof(InstanceData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        oldCount = 0; // Storage was respecified, every slot must be sent again
+    }
+
+    dirtySlots.erase(std::remove_if(dirtySlots.begin(), dirtySlots.end(),
+                                    [count](uint32_t slot) { return slot >= count; }),
+                     dirtySlots.end());
+    for (size_t slot = oldCount; slot < count; ++slot) {
+        if (!dirtyFlags[slot]) {
+            dirtyFlags[slot] = 1;
+            dirtySlots.push_back(slot);
+        }
+    }
+}
+
+void InstanceBuffer::write(size_t slot, const InstanceData& data) {
+    if (std::memcmp(&mirror[slot], &data, sizeof(InstanceData)) == 0) return;
+    mirror[slot] = data;
+    if (!dirtyFlags[slot]) {
+        dirtyFlags[slot] = 1;
+        dirtySlots.push_back(slot);
+    }
+}
+
+void InstanceBuffer::upload() {
+    uploadedSlots = 0;
+    if (dirtySlots.empty()) return;
+
+    std::sort(dirtySlots.begin(), dirtySlots.end());
+    glBindBuffer(GL_TEXTURE_BUFFER, dataBuffer);
+    size_t i = 0;
+    while (i < dirtySlots.size()) {
+        uint32_t first = dirtySlots[i];
+        uint32_t last = first;
+        while (i + 1 < dirtySlots.size() && dirtySlots[i + 1] - last <= MAX_UPLOAD_GAP) {
+            last = dirtySlots[++i];
+        }
+        ++i;
+        glBufferSubData(GL_TEXTURE_BUFFER, first * sizeof(InstanceData),
+                        (last - first + 1) * sizeof(InstanceData), &mirror[first]);
+        uploadedSlots += last - first + 1;
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    for (uint32_t slot : dirtySlots) dirtyFlags[slot] = 0;
+    dirtySlots.clear();
+}
+
+void InstanceBuffer::bind(GLenum unit) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_BUFFER, dataTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+InstanceIndexStream::InstanceIndexStream() : indexBuffer(0), indexTexture(0), indexCapacity(0) {}
+
+InstanceIndexStream::~InstanceIndexStream() {
+    glDeleteTextures(1, &indexTexture);
+    glDeleteBuffers(1, &indexBuffer);
+}
+
+void InstanceIndexStream::init() {
+    if (!glad_glGenVertexArrays) {
+        throw std::runtime_error("OpenGL not initialized");
+    }
+
+    indexCapacity = INITIAL_SLOTS;
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, indexCapacity * sizeof(GLuint), nullptr, GL_STREAM_DRAW);
+    glGenTextures(1, &indexTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, indexBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void InstanceIndexStream::upload(const std::vector<GLuint>& indices) {
+    glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+    if (indices.size() > indexCapacity) {
+        while (indexCapacity < indices.size()) indexCapacity *= 2;
+    }
+    // Orphan last frame's indices rather than synchronizing with the draws reading them
+    glBufferData(GL_TEXTURE_BUFFER, indexCapacity * sizeof(GLuint), nullptr, GL_STREAM_DRAW);
+    if (!indices.empty()) {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, indices.size() * sizeof(GLuint), indices.data());
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void InstanceIndexStream::bind(GLenum unit) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
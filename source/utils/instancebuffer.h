@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Per-instance data as the vertex shader reads it: four texels of model
+// matrix, one texel of color and one texel of light indices (-1 = unused).
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec4 color;
+    glm::vec4 lights;
+};
+
+// Persistent per-instance store exposed to shaders as a texture buffer.
+// Slots are only re-uploaded when their contents change. One store serves
+// every view of a scene; each view selects the slots it draws through its
+// own InstanceIndexStream.
+class InstanceBuffer {
+private:
+    GLuint dataBuffer, dataTexture;
+    std::vector<InstanceData> mirror;
+    std::vector<uint8_t> dirtyFlags;
+    std::vector<uint32_t> dirtySlots;
+    size_t dataCapacity;  // In slots
+    size_t uploadedSlots; // Slots written by the last upload
+
+public:
+    InstanceBuffer();
+    ~InstanceBuffer();
+    void init();
+    void resize(size_t count);
+    size_t size() const { return mirror.size(); }
+    void write(size_t slot, const InstanceData& data);
+    void upload();
+    void bind(GLenum unit) const;
+    size_t getUploadedSlots() const { return uploadedSlots; }
+};
+
+// Per-view stream of instance slots, rewritten every frame, so any subset
+// of slots can be drawn with one instanced call.
+class InstanceIndexStream {
+private:
+    GLuint indexBuffer, indexTexture;
+    size_t indexCapacity; // In indices
+
+public:
+    InstanceIndexStream();
+    ~InstanceIndexStream();
+    void init();
+    void upload(const std::vector<GLuint>& indices);
+    void bind(GLenum unit) const;
+};
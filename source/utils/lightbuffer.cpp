@@ -0,0 +1,100 @@
+#include "lightbuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+LightBuffer::LightBuffer() : ubo(0) {}
+
+LightBuffer::~LightBuffer() {
+    glDeleteBuffers(1, &ubo);
+}
+
+void LightBuffer::init() {
+    if (!glad_glGenVertexArrays) {
+        throw std::runtime_error("OpenGL not initialized");
+    }
+
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, MAX_LIGHTS * sizeof(GpuLight), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Packs the spotlights and uploads them if anything changed. With no
+// spotlights a default white light at the origin is used, as before.
+bool LightBuffer::update(const SpotlightStore& spotlights) {
+    std::vector<GpuLight> packed;
+    size_t count = std::min<size_t>(spotlights.size(), MAX_LIGHTS);
+    packed.reserve(std::max<size_t>(count, 1));
+    for (size_t i = 0; i < count; ++i) {
+        float cutoff = glm::radians(spotlights.cutoffs[i]);
+        glm::vec3 direction = spotlights.directions[i];
+        float length = glm::length(direction);
+        direction = length > 0.0f ? direction / length : glm::vec3(0.0f, 0.0f, -1.0f);
+        packed.push_back({glm::vec4(spotlights.positions[i], std::cos(cutoff)),
+                          glm::vec4(direction, spotlights.intensities[i]),
+                          spotlights.colors[i]});
+    }
+    if (packed.empty()) {
+        // A default Spotlight's components
+        packed.push_back({glm::vec4(0.0f, 0.0f, 0.0f, std::cos(glm::radians(12.5f))),
+                          glm::vec4(0.0f, 0.0f, -1.0f, 1.0f),
+                          glm::vec4(1.0f)});
+    }
+
+    if (packed.size() == lights.size() &&
+        std::memcmp(packed.data(), lights.data(), packed.size() * sizeof(GpuLight)) == 0) {
+        return false;
+    }
+
+    lights.swap(packed);
+    sinCutoffs.resize(lights.size());
+    for (size_t i = 0; i < lights.size(); ++i) {
+        sinCutoffs[i] = std::sqrt(std::max(0.0f, 1.0f - lights[i].position.w * lights[i].position.w));
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, lights.size() * sizeof(GpuLight), lights.data());
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    return true;
+}
+
+void LightBuffer::bind(GLuint binding) const {
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, ubo);
+}
+
+// Returns up to MAX_LIGHTS_PER_OBJECT indices of lights whose cone touches
+// the bounding sphere, brightest first; unused entries are -1.
+glm::vec4 LightBuffer::selectLights(const Bounds& bounds) const {
+    int chosen[MAX_LIGHTS_PER_OBJECT];
+    int count = 0;
+    for (size_t i = 0; i < lights.size(); ++i) {
+        const GpuLight& light = lights[i];
+        glm::vec3 toCenter = bounds.center - glm::vec3(light.position);
+        float distance2 = glm::dot(toCenter, toCenter);
+        if (distance2 > bounds.radius * bounds.radius) {
+            // Sphere-cone test: distance from the sphere center to the cone surface.
+            // The shader lights fragments along -direction, so the cone axis is flipped.
+            float along = -glm::dot(toCenter, glm::vec3(light.direction));
+            float across = std::sqrt(std::max(0.0f, distance2 - along * along));
+            float outside = light.position.w * across - sinCutoffs[i] * along;
+            if (outside > bounds.radius || along < -bounds.radius) continue;
+        }
+
+        if (count < MAX_LIGHTS_PER_OBJECT) {
+            chosen[count++] = i;
+        } else {
+            // Replace the dimmest chosen light
+            int dimmest = 0;
+            for (int j = 1; j < count; ++j) {
+                if (lights[chosen[j]].direction.w < lights[chosen[dimmest]].direction.w) dimmest = j;
+            }
+            if (light.direction.w > lights[chosen[dimmest]].direction.w) chosen[dimmest] = i;
+        }
+    }
+
+    std::sort(chosen, chosen + count, [this](int a, int b) { return lights[a].direction.w > lights[b].direction.w; });
+    glm::vec4 result(-1.0f);
+    for (int j = 0; j < count; ++j) result[j] = (float)chosen[j];
+    return result;
+}
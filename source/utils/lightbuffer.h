@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "spotlight.h"
+#include "frustum.h"
+
+const int MAX_LIGHTS = 64;
+const int MAX_LIGHTS_PER_OBJECT = 4;
+
+// One spotlight in std140 layout. position.w holds cos(cutoff) so the
+// fragment shader does not evaluate it; direction is normalized and
+// direction.w holds the intensity.
+struct GpuLight {
+    glm::vec4 position;
+    glm::vec4 direction;
+    glm::vec4 color;
+};
+
+// Uniform buffer with every spotlight of a renderer, plus the CPU-side
+// cone tests that pick the lights reaching each object.
+class LightBuffer {
+private:
+    GLuint ubo;
+    std::vector<GpuLight> lights;
+    std::vector<float> sinCutoffs;
+
+public:
+    LightBuffer();
+    ~LightBuffer();
+    void init();
+    bool update(const SpotlightStore& spotlights);
+    void bind(GLuint binding) const;
+    glm::vec4 selectLights(const Bounds& bounds) const;
+    size_t size() const { return lights.size(); }
+};
@@ -0,0 +1,106 @@
+#include "mappedfile.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile() : address(nullptr), length(0) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping keeps its own reference to the file
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return false;
+
+    address = mapped;
+    length = info.st_size;
+    return true;
+}
+
+void MappedFile::prefetch() const {
+    if (address) {
+        madvise(address, length, MADV_WILLNEED);
+    }
+}
+
+void MappedFile::close() {
+    if (address) {
+        munmap(address, length);
+        address = nullptr;
+        length = 0;
+    }
+}
+
+MappedFileWriter::MappedFileWriter(const std::string& label) : label(label) {}
+
+MappedFileWriter::~MappedFileWriter() {
+    if (temporary.empty()) return;
+    file.close();
+    std::error_code ec;
+    std::filesystem::remove(temporary, ec);
+}
+
+bool MappedFileWriter::open(const std::string& path) {
+    this->path = path;
+    std::error_code ec;
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), ec);
+    }
+    // Unique per process and writer, so concurrent saves of one path never
+    // write the same temporary; the last rename wins
+    static std::atomic<unsigned> counter(0);
+    temporary = path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(counter++);
+    file.open(temporary, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Cannot write " << label << ": " << path << std::endl;
+        temporary.clear();
+        return false;
+    }
+    return true;
+}
+
+void MappedFileWriter::write(const void* data, size_t bytes) {
+    file.write(static_cast<const char*>(data), bytes);
+}
+
+void MappedFileWriter::padTo(uint64_t offset) {
+    static const char padding[ALIGNMENT] = {};
+    for (uint64_t position = file.tellp(); file && position < offset; position = file.tellp()) {
+        file.write(padding, std::min<uint64_t>(offset - position, ALIGNMENT));
+    }
+}
+
+bool MappedFileWriter::commit() {
+    file.close();
+    if (!file) {
+        std::cerr << "Cannot write " << label << ": " << path << std::endl;
+        return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        std::cerr << "Cannot write " << label << ": " << path << ": " << ec.message() << std::endl;
+        return false;
+    }
+    temporary.clear();
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <fstream>
+#include <cstddef>
+#include <cstdint>
+
+// Read-only memory mapping of a whole file, unmapped on destruction or close().
+class MappedFile {
+private:
+    void* address;
+    size_t length;
+
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // False when the file is missing, empty or cannot be mapped
+    bool open(const std::string& path);
+    void close();
+    // Starts reading the whole file in so later accesses do not fault
+    void prefetch() const;
+    bool isOpen() const { return address != nullptr; }
+    const unsigned char* data() const { return static_cast<const unsigned char*>(address); }
+    size_t size() const { return length; }
+};
+
+// Writes a file laid out for MappedFile readers: blocks at aligned offsets,
+// written under a temporary name and renamed into place by commit(), so a
+// reader never maps a partial file. Failures are reported with label.
+class MappedFileWriter {
+private:
+    std::string path;
+    std::string temporary;
+    std::string label;
+    std::ofstream file;
+
+public:
+    static constexpr uint64_t ALIGNMENT = 16;
+    static uint64_t align(uint64_t offset) { return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+    // label names the kind of file in messages, e.g. "mesh cache"
+    explicit MappedFileWriter(const std::string& label);
+    // Removes the temporary file unless committed
+    ~MappedFileWriter();
+    MappedFileWriter(const MappedFileWriter&) = delete;
+    MappedFileWriter& operator=(const MappedFileWriter&) = delete;
+
+    // Creates missing directories; false when the file cannot be created
+    bool open(const std::string& path);
+    void write(const void* data, size_t bytes);
+    // Writes zeros up to offset, which must not be behind the current position
+    void padTo(uint64_t offset);
+    // Renames the finished file into place; false when any write failed
+    bool commit();
+};
@@ -1,57 +1,106 @@
 
 #include "mesh.h"
-#include <tinyobjloader/tiny_obj_loader.h>
+#include "meshoptimize.h"
+#include "objparser.h"
 #include <iostream>
-#include <fstream>
+#include <unordered_map>
 
-Mesh::Mesh(const std::string& path) : Shape("Mesh"), objPath(path) {}
+namespace {
 
-void Mesh::init() {
-    if (!glad_glGenVertexArrays) {
-        throw std::runtime_error("OpenGL not initialized");
+// One OBJ face corner; corners with the same three indices are the same vertex
+struct ObjCorner {
+    int position, normal, uv;
+    bool operator==(const ObjCorner& other) const {
+        return position == other.position && normal == other.normal && uv == other.uv;
     }
+};
 
-    std::ifstream file(objPath);
-    if (!file.good()) {
-        throw std::runtime_error("Cannot open .obj file: " + objPath);
+struct ObjCornerHash {
+    size_t operator()(const ObjCorner& corner) const {
+        size_t hash = std::hash<int>()(corner.position);
+        hash ^= std::hash<int>()(corner.normal) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        hash ^= std::hash<int>()(corner.uv) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        return hash;
     }
-    file.close();
+};
 
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
+} // namespace
 
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, objPath.c_str())) {
-        throw std::runtime_error("Failed to load .obj file: " + objPath + "\n" + warn + err);
+Mesh::Mesh(ShapeStore& store, const std::string& path) : Shape(store, "Mesh"), objPath(path) {}
+
+void Mesh::init(GeometryCache& cache) {
+    store->geometries[id] = cache.acquireMesh(objPath, [this](MeshData& mesh) {
+        loadObj(objPath, mesh);
+    });
+    store->markTransformDirty(id); // World bounds depend on the geometry
+}
+
+void Mesh::loadObj(const std::string& path, MeshData& mesh, unsigned threads) {
+    ObjData obj;
+    ObjParser::parse(path, obj, threads);
+
+    mesh.clear();
+
+    // Normals and UVs are kept only when every corner has them
+    size_t cornerCount = obj.corners.size();
+    bool hasNormals = !obj.normals.empty();
+    bool hasUvs = !obj.texcoords.empty();
+    for (const ObjData::Corner& corner : obj.corners) {
+        hasNormals = hasNormals && corner.normal >= 0;
+        hasUvs = hasUvs && corner.texcoord >= 0;
     }
 
-    vertices.clear();
-    indices.clear();
+    // Scan exports often index every attribute with the position's index;
+    // then the attribute arrays already are the vertices and need no hashing
+    bool sharedIndices = true;
+    for (const ObjData::Corner& corner : obj.corners) {
+        sharedIndices = sharedIndices && (!hasNormals || corner.normal == corner.position)
+                                      && (!hasUvs || corner.texcoord == corner.position);
+    }
 
-    for (const auto& shape : shapes) {
-        for (const auto& index : shape.mesh.indices) {
-            vertices.push_back(attrib.vertices[3 * index.vertex_index + 0]);
-            vertices.push_back(attrib.vertices[3 * index.vertex_index + 1]);
-            vertices.push_back(attrib.vertices[3 * index.vertex_index + 2]);
-            indices.push_back(indices.size());
+    if (sharedIndices) {
+        mesh.positions = std::move(obj.positions);
+        if (hasNormals) {
+            mesh.normals = std::move(obj.normals);
+            mesh.normals.resize(mesh.positions.size());
+        }
+        if (hasUvs) {
+            mesh.uvs = std::move(obj.texcoords);
+            mesh.uvs.resize(mesh.vertexCount() * 2);
+        }
+        mesh.indices.resize(cornerCount);
+        for (size_t i = 0; i < cornerCount; ++i) {
+            mesh.indices[i] = obj.corners[i].position;
+        }
+    } else {
+        std::unordered_map<ObjCorner, uint32_t, ObjCornerHash> vertexIds;
+        vertexIds.reserve(cornerCount);
+        mesh.indices.reserve(cornerCount);
+        for (const ObjData::Corner& index : obj.corners) {
+            ObjCorner corner{index.position, hasNormals ? index.normal : -1, hasUvs ? index.texcoord : -1};
+            auto inserted = vertexIds.emplace(corner, (uint32_t)mesh.vertexCount());
+            if (inserted.second) {
+                mesh.positions.insert(mesh.positions.end(), &obj.positions[3 * corner.position], &obj.positions[3 * corner.position] + 3);
+                if (hasNormals) {
+                    mesh.normals.insert(mesh.normals.end(), &obj.normals[3 * corner.normal], &obj.normals[3 * corner.normal] + 3);
+                }
+                if (hasUvs) {
+                    mesh.uvs.insert(mesh.uvs.end(), &obj.texcoords[2 * corner.uv], &obj.texcoords[2 * corner.uv] + 2);
+                }
+            }
+            mesh.indices.push_back(inserted.first->second);
         }
     }
+    mesh.submeshes = std::move(obj.groups);
 
-    if (vertices.empty() || indices.empty()) {
-        throw std::runtime_error("No vertices or indices loaded from .obj file: " + objPath);
+    if (mesh.positions.empty() || mesh.indices.empty()) {
+        throw std::runtime_error("No vertices or indices loaded from .obj file: " + path);
     }
 
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glGenBuffers(1, &ebo);
-
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindVertexArray(0);
+    float acmrBefore = MeshOptimize::computeAcmr(mesh.indices, mesh.vertexCount());
+    MeshOptimize::optimizeVertexCache(mesh.indices, mesh.vertexCount(), mesh.submeshes);
+    MeshOptimize::optimizeVertexFetch(mesh);
+    float acmrAfter = MeshOptimize::computeAcmr(mesh.indices, mesh.vertexCount());
+    std::cout << "Loaded " << path << ": " << mesh.vertexCount() << " vertices from " << cornerCount
+              << " corners, ACMR " << acmrBefore << " -> " << acmrAfter << std::endl;
 }
@@ -8,7 +8,10 @@ private:
     std::string objPath;
 
 public:
-    Mesh(const std::string& path);
-    void init() override;
+    Mesh(ShapeStore& store, const std::string& path);
+    void init(GeometryCache& cache) override;
+    // Shares vertices between faces and reorders them for the GPU's vertex cache.
+    // threads caps the parser's threads; 0 uses every hardware thread.
+    static void loadObj(const std::string& path, MeshData& mesh, unsigned threads = 0);
     std::string getObjPath() const { return objPath; }
 };
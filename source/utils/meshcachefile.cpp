@@ -0,0 +1,160 @@
+#include "meshcachefile.h"
+#include "geometry.h"
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+const char MAGIC[4] = {'O', 'M', 'S', 'H'};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexType;
+    uint32_t positionType;
+    uint32_t stride;
+    int32_t normalOffset;
+    int32_t uvOffset;
+    uint32_t submeshCount;
+    float boundsMin[3];
+    float boundsMax[3];
+    float boundsCenter[3];
+    float boundsRadius;
+    uint32_t pathLength;
+    uint32_t reserved;
+    uint64_t submeshOffset;
+    uint64_t vertexOffset;
+    uint64_t vertexBytes;
+    uint64_t indexOffset;
+    uint64_t indexBytes;
+};
+static_assert(sizeof(Header) == 144, "Mesh cache header layout changed; bump VERSION");
+
+// Size and modification time of the source, the cache key besides its path
+bool sourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& time) {
+    std::error_code ec;
+    size = std::filesystem::file_size(sourcePath, ec);
+    if (ec) return false;
+    time = std::filesystem::last_write_time(sourcePath, ec).time_since_epoch().count();
+    return !ec;
+}
+
+} // namespace
+
+std::string MeshCacheFile::pathFor(const std::string& sourcePath, const std::string& directory) {
+    if (directory.empty()) {
+        return sourcePath + ".omesh";
+    }
+    std::string canonical = GeometryCache::canonicalPath(sourcePath);
+    std::ostringstream name;
+    name << std::filesystem::path(canonical).stem().string() << "-"
+         << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string>()(canonical) << ".omesh";
+    return (std::filesystem::path(directory) / name.str()).string();
+}
+
+bool MeshCacheFile::open(const std::string& cachePath, const std::string& sourcePath, GLenum positionType, PackedGeometry& packed) {
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (!sourceStamp(sourcePath, sourceSize, sourceTime) || !mapping.open(cachePath)) {
+        return false;
+    }
+
+    const unsigned char* data = mapping.data();
+    size_t size = mapping.size();
+    Header header;
+    if (size < sizeof(header)) {
+        mapping.close();
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    std::string canonical = GeometryCache::canonicalPath(sourcePath);
+    size_t indexSize = header.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+    bool valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+        && header.version == VERSION
+        && header.sourceSize == sourceSize
+        && header.sourceTime == sourceTime
+        && header.positionType == positionType
+        && header.pathLength == canonical.size()
+        && sizeof(header) + header.pathLength <= size
+        && std::memcmp(data + sizeof(header), canonical.data(), canonical.size()) == 0
+        && header.submeshOffset + header.submeshCount * sizeof(Submesh) <= size
+        && header.vertexBytes == (uint64_t)header.vertexCount * header.stride
+        && header.vertexOffset + header.vertexBytes <= size
+        && header.indexBytes == header.indexCount * indexSize
+        && header.indexOffset + header.indexBytes <= size;
+    if (!valid) {
+        mapping.close();
+        return false;
+    }
+
+    packed.vertexCount = header.vertexCount;
+    packed.indexCount = header.indexCount;
+    packed.indexType = header.indexType;
+    packed.positionType = header.positionType;
+    packed.stride = header.stride;
+    packed.normalOffset = header.normalOffset;
+    packed.uvOffset = header.uvOffset;
+    packed.bounds.min = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    packed.bounds.max = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    packed.bounds.center = glm::vec3(header.boundsCenter[0], header.boundsCenter[1], header.boundsCenter[2]);
+    packed.bounds.radius = header.boundsRadius;
+    packed.submeshes.resize(header.submeshCount);
+    std::memcpy(packed.submeshes.data(), data + header.submeshOffset, header.submeshCount * sizeof(Submesh));
+    packed.vertexData = data + header.vertexOffset;
+    packed.vertexBytes = header.vertexBytes;
+    packed.indexData = data + header.indexOffset;
+    packed.indexBytes = header.indexBytes;
+    return true;
+}
+
+bool MeshCacheFile::write(const std::string& cachePath, const std::string& sourcePath, const PackedGeometry& packed) {
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    if (!sourceStamp(sourcePath, header.sourceSize, header.sourceTime)) {
+        return false;
+    }
+
+    std::string canonical = GeometryCache::canonicalPath(sourcePath);
+    header.vertexCount = packed.vertexCount;
+    header.indexCount = packed.indexCount;
+    header.indexType = packed.indexType;
+    header.positionType = packed.positionType;
+    header.stride = packed.stride;
+    header.normalOffset = packed.normalOffset;
+    header.uvOffset = packed.uvOffset;
+    header.submeshCount = packed.submeshes.size();
+    for (int axis = 0; axis < 3; ++axis) {
+        header.boundsMin[axis] = packed.bounds.min[axis];
+        header.boundsMax[axis] = packed.bounds.max[axis];
+        header.boundsCenter[axis] = packed.bounds.center[axis];
+    }
+    header.boundsRadius = packed.bounds.radius;
+    header.pathLength = canonical.size();
+    header.submeshOffset = MappedFileWriter::align(sizeof(header) + canonical.size());
+    header.vertexOffset = MappedFileWriter::align(header.submeshOffset + packed.submeshes.size() * sizeof(Submesh));
+    header.vertexBytes = packed.vertexBytes;
+    header.indexOffset = MappedFileWriter::align(header.vertexOffset + packed.vertexBytes);
+    header.indexBytes = packed.indexBytes;
+
+    MappedFileWriter file("mesh cache");
+    if (!file.open(cachePath)) {
+        return false;
+    }
+    file.write(&header, sizeof(header));
+    file.write(canonical.data(), canonical.size());
+    file.padTo(header.submeshOffset);
+    file.write(packed.submeshes.data(), packed.submeshes.size() * sizeof(Submesh));
+    file.padTo(header.vertexOffset);
+    file.write(packed.vertexData, packed.vertexBytes);
+    file.padTo(header.indexOffset);
+    file.write(packed.indexData, packed.indexBytes);
+    return file.commit();
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <glad/glad.h>
+#include "mappedfile.h"
+
+struct PackedGeometry;
+
+// Binary copy of a mesh already packed for the GPU, written the first time
+// its .obj loads. Layout: header, source path, submesh table, vertex stream,
+// index stream, each section 16-byte aligned. The file records the source's
+// size and modification time and is ignored once either changes.
+class MeshCacheFile {
+private:
+    MappedFile mapping;
+
+public:
+    static const uint32_t VERSION = 1;
+
+    // <directory>/<name>-<path hash>.omesh, or <source>.omesh when directory is empty
+    static std::string pathFor(const std::string& sourcePath, const std::string& directory);
+    // Maps the file and points packed into it; false when it is missing, stale
+    // or stores positions other than positionType. The mapping lives as long
+    // as this object.
+    bool open(const std::string& cachePath, const std::string& sourcePath, GLenum positionType, PackedGeometry& packed);
+    void prefetch() const { mapping.prefetch(); }
+    // Failures are reported and otherwise ignored; the mesh just loads from source next time
+    static bool write(const std::string& cachePath, const std::string& sourcePath, const PackedGeometry& packed);
+};
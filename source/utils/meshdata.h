@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Index range drawn from one OBJ object or group
+struct Submesh {
+    uint32_t indexOffset;
+    uint32_t indexCount;
+};
+
+// CPU-side geometry as produced by loaders and primitive builders.
+// Streams are parallel: positions holds 3 floats per vertex, normals 3 and
+// uvs 2 when present. Empty optional streams are left out of the upload.
+struct MeshData {
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<float> uvs;
+    std::vector<uint32_t> indices;
+    std::vector<Submesh> submeshes; // Empty means one range covering every index
+
+    size_t vertexCount() const { return positions.size() / 3; }
+    bool hasNormals() const { return !normals.empty(); }
+    bool hasUvs() const { return !uvs.empty(); }
+    void clear() {
+        positions.clear();
+        normals.clear();
+        uvs.clear();
+        indices.clear();
+        submeshes.clear();
+    }
+};
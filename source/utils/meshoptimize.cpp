@@ -0,0 +1,199 @@
+#include "meshoptimize.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Forsyth's tuning constants
+const int CACHE_SIZE = 32;
+const float CACHE_DECAY_POWER = 1.5f;
+const float LAST_TRIANGLE_SCORE = 0.75f;
+const float VALENCE_BOOST_SCALE = 2.0f;
+const float VALENCE_BOOST_POWER = 0.5f;
+const uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+// Vertices just used score highest, then ones still in the cache; vertices
+// with few triangles left get a boost so they are finished off early.
+float vertexScore(int cachePosition, uint32_t liveTriangles) {
+    if (liveTriangles == 0) return -1.0f;
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            score = LAST_TRIANGLE_SCORE;
+        } else {
+            float scaler = 1.0f / (CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+        }
+    }
+    return score + VALENCE_BOOST_SCALE * std::pow((float)liveTriangles, -VALENCE_BOOST_POWER);
+}
+
+} // namespace
+
+float MeshOptimize::computeAcmr(const std::vector<uint32_t>& indices, size_t vertexCount, int cacheSize) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return 0.0f;
+
+    // A vertex is cached if it was inserted within the last cacheSize misses
+    std::vector<uint32_t> insertedAt(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    size_t misses = 0;
+    for (uint32_t index : indices) {
+        if (time - insertedAt[index] > (uint32_t)cacheSize) {
+            insertedAt[index] = time++;
+            ++misses;
+        }
+    }
+    return (float)misses / triangleCount;
+}
+
+void MeshOptimize::optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    // Triangles using each vertex; the first liveCount[v] entries of a
+    // vertex's range are the ones not emitted yet
+    std::vector<uint32_t> liveCount(vertexCount, 0);
+    for (uint32_t index : indices) ++liveCount[index];
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] = offsets[v] + liveCount[v];
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) adjacency[cursor[indices[t * 3 + k]]++] = t;
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) vertexScores[v] = vertexScore(-1, liveCount[v]);
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    uint32_t best = 0;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const uint32_t* tri = &indices[t * 3];
+        triangleScores[t] = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+        if (triangleScores[t] > triangleScores[best]) best = t;
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    uint32_t cache[CACHE_SIZE + 3];
+    int cacheCount = 0;
+    size_t deadEndCursor = 0;
+
+    while (output.size() < indices.size()) {
+        if (best == NONE) {
+            // Nothing in the cache has triangles left; continue with the
+            // next unemitted triangle in input order
+            while (emitted[deadEndCursor]) ++deadEndCursor;
+            best = deadEndCursor;
+        }
+
+        const uint32_t* tri = &indices[best * 3];
+        emitted[best] = 1;
+        for (int k = 0; k < 3; ++k) {
+            uint32_t v = tri[k];
+            output.push_back(v);
+            uint32_t* first = &adjacency[offsets[v]];
+            uint32_t* last = first + liveCount[v];
+            uint32_t* it = std::find(first, last, best);
+            if (it != last) {
+                std::swap(*it, *(last - 1));
+                --liveCount[v];
+            }
+        }
+
+        // Move the triangle's vertices to the front of the LRU cache
+        uint32_t updated[CACHE_SIZE + 3];
+        int updatedCount = 0;
+        for (int k = 0; k < 3; ++k) {
+            if (std::find(updated, updated + updatedCount, tri[k]) == updated + updatedCount) {
+                updated[updatedCount++] = tri[k];
+            }
+        }
+        for (int i = 0; i < cacheCount; ++i) {
+            if (std::find(updated, updated + updatedCount, cache[i]) == updated + updatedCount) {
+                updated[updatedCount++] = cache[i];
+            }
+        }
+        for (int i = 0; i < updatedCount; ++i) {
+            uint32_t v = updated[i];
+            cachePosition[v] = i < CACHE_SIZE ? i : -1;
+            vertexScores[v] = vertexScore(cachePosition[v], liveCount[v]);
+        }
+
+        // Only triangles touching the cache changed score; pick the best of them
+        best = NONE;
+        float bestScore = -1.0f;
+        for (int i = 0; i < updatedCount; ++i) {
+            uint32_t v = updated[i];
+            for (uint32_t j = 0; j < liveCount[v]; ++j) {
+                uint32_t t = adjacency[offsets[v] + j];
+                const uint32_t* other = &indices[t * 3];
+                triangleScores[t] = vertexScores[other[0]] + vertexScores[other[1]] + vertexScores[other[2]];
+                if (triangleScores[t] > bestScore) {
+                    bestScore = triangleScores[t];
+                    best = t;
+                }
+            }
+        }
+
+        cacheCount = std::min(updatedCount, CACHE_SIZE);
+        std::copy(updated, updated + cacheCount, cache);
+    }
+    indices.swap(output);
+}
+
+void MeshOptimize::optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, const std::vector<Submesh>& submeshes) {
+    if (submeshes.size() <= 1) {
+        optimizeVertexCache(indices, vertexCount);
+        return;
+    }
+
+    // Each range is renumbered locally so the work stays proportional to its size
+    std::vector<uint32_t> local(vertexCount, NONE);
+    std::vector<uint32_t> global;
+    std::vector<uint32_t> range;
+    for (const Submesh& submesh : submeshes) {
+        global.clear();
+        range.resize(submesh.indexCount);
+        for (uint32_t i = 0; i < submesh.indexCount; ++i) {
+            uint32_t v = indices[submesh.indexOffset + i];
+            if (local[v] == NONE) {
+                local[v] = global.size();
+                global.push_back(v);
+            }
+            range[i] = local[v];
+        }
+        optimizeVertexCache(range, global.size());
+        for (uint32_t i = 0; i < submesh.indexCount; ++i) {
+            indices[submesh.indexOffset + i] = global[range[i]];
+        }
+        for (uint32_t v : global) local[v] = NONE;
+    }
+}
+
+void MeshOptimize::optimizeVertexFetch(MeshData& mesh) {
+    size_t vertexCount = mesh.vertexCount();
+    std::vector<uint32_t> remap(vertexCount, NONE);
+    uint32_t next = 0;
+    for (uint32_t& index : mesh.indices) {
+        if (remap[index] == NONE) remap[index] = next++;
+        index = remap[index];
+    }
+
+    // Unreferenced vertices are dropped
+    auto reorder = [&](std::vector<float>& stream, int components) {
+        if (stream.empty()) return;
+        std::vector<float> reordered(next * components);
+        for (size_t v = 0; v < vertexCount; ++v) {
+            if (remap[v] == NONE) continue;
+            std::copy(&stream[v * components], &stream[v * components] + components, &reordered[remap[v] * components]);
+        }
+        stream.swap(reordered);
+    };
+    reorder(mesh.positions, 3);
+    reorder(mesh.normals, 3);
+    reorder(mesh.uvs, 2);
+}
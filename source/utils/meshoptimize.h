@@ -0,0 +1,25 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "meshdata.h"
+
+// Index and vertex reordering for indexed triangle lists.
+namespace MeshOptimize {
+    // Hardware-like FIFO cache size used when measuring ACMR
+    const int ACMR_CACHE_SIZE = 16;
+
+    // Average cache miss ratio: post-transform cache misses per triangle,
+    // simulated with a FIFO cache. 3.0 is the worst case, ~0.5 is excellent.
+    float computeAcmr(const std::vector<uint32_t>& indices, size_t vertexCount, int cacheSize = ACMR_CACHE_SIZE);
+
+    // Reorders triangles for post-transform cache locality (Forsyth's
+    // linear-speed vertex cache optimisation). Vertices are not moved.
+    void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+    // Same, per submesh, so every submesh keeps its own index range
+    void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, const std::vector<Submesh>& submeshes);
+
+    // Renumbers vertices in order of first use by the index buffer, so the
+    // vertex fetch walks memory mostly forwards. Run after optimizeVertexCache.
+    void optimizeVertexFetch(MeshData& mesh);
+}
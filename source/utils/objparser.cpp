@@ -0,0 +1,357 @@
+#include "objparser.h"
+#include "mappedfile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// Smaller chunks are not worth a thread
+const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+const double POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+enum class Statement { Position, Normal, Texcoord, Face, Group, Other };
+
+struct Counts {
+    size_t positions = 0;
+    size_t normals = 0;
+    size_t texcoords = 0;
+    size_t corners = 0;
+};
+
+struct Chunk {
+    const char* begin;
+    const char* end;
+    Counts counts;                  // Statements in this chunk
+    Counts base;                    // Statements in every earlier chunk
+    std::vector<uint32_t> groupStarts;
+    std::exception_ptr error;
+};
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) ++p;
+    return p;
+}
+
+// Classifies the line at p and moves p past the keyword
+Statement classify(const char*& p, const char* end) {
+    p = skipBlanks(p, end);
+    if (p >= end) return Statement::Other;
+    char c0 = *p;
+    char c1 = p + 1 < end ? p[1] : '\n';
+    if (c0 == 'v') {
+        if (isBlank(c1)) { p += 1; return Statement::Position; }
+        char c2 = p + 2 < end ? p[2] : '\n';
+        if (c1 == 'n' && isBlank(c2)) { p += 2; return Statement::Normal; }
+        if (c1 == 't' && isBlank(c2)) { p += 2; return Statement::Texcoord; }
+    } else if (c0 == 'f' && isBlank(c1)) {
+        p += 1;
+        return Statement::Face;
+    } else if ((c0 == 'o' || c0 == 'g') && (isBlank(c1) || c1 == '\n')) {
+        p += 1;
+        return Statement::Group;
+    }
+    return Statement::Other;
+}
+
+// Decimal digits go into a 64-bit mantissa scaled by a power of ten, which
+// is exact in double for the 6-9 significant digits exporters write.
+// Anything unusual (nan, inf, very long exponents) goes through strtod.
+const char* parseFloat(const char* p, const char* end, float& value) {
+    p = skipBlanks(p, end);
+    const char* start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for (; p < end && isDigit(*p); ++p, any = true) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa) ++digits;
+        } else {
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && isDigit(*p); ++p, any = true) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa) ++digits;
+                --exponent;
+            }
+        }
+    }
+    if (any && p < end && (*p == 'e' || *p == 'E')) {
+        const char* e = p + 1;
+        bool negativeExponent = false;
+        if (e < end && (*e == '-' || *e == '+')) {
+            negativeExponent = *e == '-';
+            ++e;
+        }
+        int written = 0;
+        for (; e < end && isDigit(*e) && written < 10000; ++e) {
+            written = written * 10 + (*e - '0');
+        }
+        exponent += negativeExponent ? -written : written;
+        p = e;
+    }
+
+    if (!any || (p < end && !isBlank(*p) && *p != '\n')) {
+        char buffer[64];
+        const char* tokenEnd = start;
+        while (tokenEnd < end && !isBlank(*tokenEnd) && *tokenEnd != '\n') ++tokenEnd;
+        size_t length = std::min<size_t>(tokenEnd - start, sizeof(buffer) - 1);
+        std::memcpy(buffer, start, length);
+        buffer[length] = '\0';
+        value = std::strtof(buffer, nullptr);
+        return tokenEnd;
+    }
+
+    double result = (double)mantissa;
+    if (exponent >= -22 && exponent <= 22) {
+        result = exponent < 0 ? result / POWERS_OF_TEN[-exponent] : result * POWERS_OF_TEN[exponent];
+    } else {
+        result *= std::pow(10.0, exponent);
+    }
+    value = (float)(negative ? -result : result);
+    return p;
+}
+
+// One face index: 1-based, or negative relative to the statements so far.
+// Returns -1 when empty and throws when it points outside [0, total).
+const char* parseIndex(const char* p, const char* end, size_t before, size_t total, int32_t& index) {
+    bool negative = false;
+    if (p < end && *p == '-') {
+        negative = true;
+        ++p;
+    }
+    if (p >= end || !isDigit(*p)) {
+        index = -1;
+        return p;
+    }
+    int64_t value = 0;
+    for (; p < end && isDigit(*p); ++p) {
+        value = std::min<int64_t>(value * 10 + (*p - '0'), INT32_MAX);
+    }
+    int64_t resolved = negative ? (int64_t)before - value : value - 1;
+    if (resolved < 0 || resolved >= (int64_t)total) {
+        throw std::runtime_error("Face index out of range");
+    }
+    index = (int32_t)resolved;
+    return p;
+}
+
+const char* nextLine(const char* p, const char* end) {
+    const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return newline ? newline + 1 : end;
+}
+
+// Where a line's statement ends: at a trailing # comment, if any
+const char* stripComment(const char* line, const char* lineEnd) {
+    const char* hash = static_cast<const char*>(std::memchr(line, '#', lineEnd - line));
+    return hash ? hash : lineEnd;
+}
+
+void countChunk(Chunk& chunk) {
+    for (const char* line = chunk.begin; line < chunk.end;) {
+        const char* p = line;
+        const char* next = nextLine(line, chunk.end);
+        const char* lineEnd = stripComment(line, next);
+        switch (classify(p, lineEnd)) {
+            case Statement::Position: ++chunk.counts.positions; break;
+            case Statement::Normal: ++chunk.counts.normals; break;
+            case Statement::Texcoord: ++chunk.counts.texcoords; break;
+            case Statement::Face: {
+                size_t vertices = 0;
+                while (true) {
+                    p = skipBlanks(p, lineEnd);
+                    if (p >= lineEnd || *p == '\n') break;
+                    ++vertices;
+                    while (p < lineEnd && !isBlank(*p) && *p != '\n') ++p;
+                }
+                if (vertices >= 3) chunk.counts.corners += (vertices - 2) * 3;
+                break;
+            }
+            default: break;
+        }
+        line = next;
+    }
+}
+
+void parseChunk(Chunk& chunk, ObjData& data, const Counts& totals) {
+    float* position = data.positions.data() + chunk.base.positions * 3;
+    float* normal = data.normals.data() + chunk.base.normals * 3;
+    float* texcoord = data.texcoords.data() + chunk.base.texcoords * 2;
+    ObjData::Corner* corner = data.corners.data() + chunk.base.corners;
+    Counts seen = chunk.base;
+    std::vector<ObjData::Corner> polygon;
+
+    for (const char* line = chunk.begin; line < chunk.end;) {
+        const char* p = line;
+        const char* next = nextLine(line, chunk.end);
+        const char* lineEnd = stripComment(line, next);
+        switch (classify(p, lineEnd)) {
+            case Statement::Position:
+                p = parseFloat(p, lineEnd, position[0]);
+                p = parseFloat(p, lineEnd, position[1]);
+                parseFloat(p, lineEnd, position[2]);
+                position += 3;
+                ++seen.positions;
+                break;
+            case Statement::Normal:
+                p = parseFloat(p, lineEnd, normal[0]);
+                p = parseFloat(p, lineEnd, normal[1]);
+                parseFloat(p, lineEnd, normal[2]);
+                normal += 3;
+                ++seen.normals;
+                break;
+            case Statement::Texcoord: {
+                p = skipBlanks(parseFloat(p, lineEnd, texcoord[0]), lineEnd);
+                bool hasV = p < lineEnd && *p != '\n';
+                if (hasV) {
+                    parseFloat(p, lineEnd, texcoord[1]);
+                } else {
+                    texcoord[1] = 0.0f; // 1D texture coordinate
+                }
+                texcoord += 2;
+                ++seen.texcoords;
+                break;
+            }
+            case Statement::Face:
+                polygon.clear();
+                while (true) {
+                    p = skipBlanks(p, lineEnd);
+                    if (p >= lineEnd || *p == '\n') break;
+                    ObjData::Corner vertex{-1, -1, -1};
+                    p = parseIndex(p, lineEnd, seen.positions, totals.positions, vertex.position);
+                    if (p < lineEnd && *p == '/') {
+                        p = parseIndex(p + 1, lineEnd, seen.texcoords, totals.texcoords, vertex.texcoord);
+                        if (p < lineEnd && *p == '/') {
+                            p = parseIndex(p + 1, lineEnd, seen.normals, totals.normals, vertex.normal);
+                        }
+                    }
+                    if (vertex.position < 0) {
+                        throw std::runtime_error("Face corner without a position");
+                    }
+                    polygon.push_back(vertex);
+                    while (p < lineEnd && !isBlank(*p) && *p != '\n') ++p;
+                }
+                for (size_t i = 2; i < polygon.size(); ++i) {
+                    *corner++ = polygon[0];
+                    *corner++ = polygon[i - 1];
+                    *corner++ = polygon[i];
+                    seen.corners += 3;
+                }
+                break;
+            case Statement::Group:
+                chunk.groupStarts.push_back(seen.corners);
+                break;
+            default:
+                break;
+        }
+        line = next;
+    }
+}
+
+// Runs work on every chunk, the first on the calling thread, and rethrows the first failure
+template<typename Work>
+void forEachChunk(std::vector<Chunk>& chunks, Work work) {
+    auto guarded = [&work](Chunk& chunk) {
+        try {
+            work(chunk);
+        } catch (...) {
+            chunk.error = std::current_exception();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        threads.emplace_back(guarded, std::ref(chunks[i]));
+    }
+    guarded(chunks[0]);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (const Chunk& chunk : chunks) {
+        if (chunk.error) std::rethrow_exception(chunk.error);
+    }
+}
+
+} // namespace
+
+void ObjParser::parse(const std::string& path, ObjData& data, unsigned threads) {
+    MappedFile file;
+    if (!file.open(path)) {
+        throw std::runtime_error("Cannot open .obj file: " + path);
+    }
+    const char* begin = reinterpret_cast<const char*>(file.data());
+    const char* end = begin + file.size();
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threads, file.size() / MIN_CHUNK_BYTES));
+    std::vector<Chunk> chunks(chunkCount);
+    const char* chunkBegin = begin;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        const char* chunkEnd = i + 1 == chunkCount ? end : nextLine(begin + file.size() * (i + 1) / chunkCount - 1, end);
+        chunks[i].begin = chunkBegin;
+        chunks[i].end = std::max(chunkBegin, chunkEnd);
+        chunkBegin = chunks[i].end;
+    }
+
+    forEachChunk(chunks, countChunk);
+
+    Counts totals;
+    for (Chunk& chunk : chunks) {
+        chunk.base = totals;
+        totals.positions += chunk.counts.positions;
+        totals.normals += chunk.counts.normals;
+        totals.texcoords += chunk.counts.texcoords;
+        totals.corners += chunk.counts.corners;
+    }
+    if (totals.corners > UINT32_MAX) {
+        throw std::runtime_error("Too many face corners in .obj file: " + path);
+    }
+
+    data.positions.resize(totals.positions * 3);
+    data.normals.resize(totals.normals * 3);
+    data.texcoords.resize(totals.texcoords * 2);
+    data.corners.resize(totals.corners);
+    try {
+        forEachChunk(chunks, [&data, &totals](Chunk& chunk) { parseChunk(chunk, data, totals); });
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Failed to load .obj file: " + path + "\n" + e.what());
+    }
+
+    // Group boundaries become corner ranges; corners before the first o/g form their own group
+    data.groups.clear();
+    uint32_t start = 0;
+    auto closeGroup = [&data, &start](uint32_t next) {
+        if (next > start) data.groups.push_back({start, next - start});
+        start = next;
+    };
+    for (const Chunk& chunk : chunks) {
+        for (uint32_t groupStart : chunk.groupStarts) closeGroup(groupStart);
+    }
+    closeGroup(totals.corners);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "meshdata.h"
+
+// Contents of an .obj file as written: the attribute arrays, and the face
+// corners (polygons fan-triangulated) indexing them from 0, -1 where a
+// corner has no such attribute. Each o or g statement starts a new group.
+struct ObjData {
+    struct Corner {
+        int32_t position;
+        int32_t texcoord;
+        int32_t normal;
+    };
+
+    std::vector<float> positions;   // 3 per vertex
+    std::vector<float> normals;     // 3 per normal
+    std::vector<float> texcoords;   // 2 per texcoord
+    std::vector<Corner> corners;
+    std::vector<Submesh> groups;    // Corner ranges; empty groups are left out
+};
+
+// Parallel .obj reader. The file is mapped and split at line boundaries
+// into one chunk per thread; a first pass counts each chunk's statements,
+// so the second can parse every chunk straight into its slice of the
+// output arrays. Materials, lines, points and smoothing groups are ignored.
+class ObjParser {
+public:
+    // threads 0 uses every hardware thread. Throws std::runtime_error when
+    // the file cannot be read or a face index is out of range.
+    static void parse(const std::string& path, ObjData& data, unsigned threads = 0);
+};
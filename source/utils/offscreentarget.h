@@ -0,0 +1,21 @@
+#pragma once
+#include <glad/glad.h>
+
+// Color and depth renderbuffers a headless window draws into instead of
+// its default framebuffer. Framebuffer objects are per-context, so each
+// window owns its own.
+class OffscreenTarget {
+private:
+    GLuint fbo, colorBuffer, depthBuffer;
+    int width, height;
+
+public:
+    OffscreenTarget();
+    ~OffscreenTarget();
+    void init(int width, int height);
+    // Respecifies the attachments only when the size changed
+    void resize(int width, int height);
+    void bind() const;
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+};
@@ -0,0 +1,76 @@
+#include "presentscheduler.h"
+#include "renderer.h"
+#include <iostream>
+
+static const double DEFAULT_PERIOD_MS = 1000.0 / 60.0;
+
+PresentScheduler::PresentScheduler() : hasVblank(false), paced(true), periodMs(DEFAULT_PERIOD_MS) {}
+
+double PresentScheduler::elapsedMs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+void PresentScheduler::addWindow(Window* window) {
+    SDL_GL_MakeCurrent(window->GetWindow(), window->GetGLContext());
+    if (windows.empty() && window->IsHeadless()) {
+        paced = false; // Offscreen frames have no vblank; run as fast as they draw
+    } else if (windows.empty()) {
+        // Adaptive vsync tears instead of stalling a whole period on a late frame
+        if (SDL_GL_SetSwapInterval(-1) < 0 && SDL_GL_SetSwapInterval(1) < 0) {
+            std::cerr << "Vsync unavailable: " << SDL_GetError() << std::endl;
+        }
+        SDL_DisplayMode mode;
+        if (SDL_GetWindowDisplayMode(window->GetWindow(), &mode) == 0 && mode.refresh_rate > 0) {
+            periodMs = 1000.0 / mode.refresh_rate;
+        }
+    } else {
+        SDL_GL_SetSwapInterval(0);
+    }
+    windows.push_back(window);
+}
+
+void PresentScheduler::beginFrame() {
+    frameStart = Clock::now();
+}
+
+void PresentScheduler::present(Window* window, const SceneSnapshot& snapshot, int* state, std::vector<Renderer*>& allRenderers) {
+    window->SampleSize();
+    Clock::time_point drawStart = Clock::now();
+    window->Draw(snapshot, state, allRenderers);
+    Clock::time_point drawEnd = Clock::now();
+    window->Present();
+    Clock::time_point presentEnd = Clock::now();
+    window->GetPresentStats().record(elapsedMs(drawStart, drawEnd), elapsedMs(frameStart, presentEnd));
+    window->renderer->publishCounts();
+}
+
+void PresentScheduler::drawFrame(const SceneSnapshot& snapshot, int* state, std::vector<Renderer*>& allRenderers) {
+    if (windows.empty()) return;
+    Window* primary = windows.front();
+
+    // The primary's swap blocks until vblank, which makes it the frame's
+    // pacing point; everything else has to fit in before it.
+    Clock::time_point deadline = hasVblank ? lastVblank + std::chrono::duration_cast<Clock::duration>(
+                                                 std::chrono::duration<double, std::milli>(periodMs))
+                                           : frameStart;
+    if (deadline < frameStart) {
+        deadline = frameStart;
+    }
+    double reserveMs = primary->GetPresentStats().drawMs;
+
+    for (size_t i = 1; i < windows.size(); ++i) {
+        Window* window = windows[i];
+        PresentStats& stats = window->GetPresentStats();
+        double remainingMs = elapsedMs(Clock::now(), deadline) - reserveMs;
+        if (hasVblank && stats.drawMs > remainingMs && stats.deferredInARow < MAX_DEFERRED_FRAMES) {
+            ++stats.deferredInARow;
+            ++stats.deferredFrames;
+            continue;
+        }
+        present(window, snapshot, state, allRenderers);
+    }
+
+    present(primary, snapshot, state, allRenderers);
+    lastVblank = Clock::now();
+    hasVblank = paced;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include "window.h"
+
+class Renderer;
+struct SceneSnapshot;
+
+// Paces every window against one frame deadline set by the primary
+// window's vblank. Only the primary swaps with vsync, and it presents
+// last; secondary windows swap immediately and are deferred to a later
+// frame when their expected draw time would make the primary miss its
+// deadline.
+class PresentScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    std::vector<Window*> windows;       // Primary first
+    Clock::time_point frameStart;
+    Clock::time_point lastVblank;       // When the primary's last swap returned
+    bool hasVblank;
+    bool paced;                         // False when the primary is headless
+    double periodMs;                    // Primary display refresh period
+
+    void present(Window* window, const SceneSnapshot& snapshot, int* state, std::vector<Renderer*>& allRenderers);
+
+public:
+    // Secondary windows are never skipped more than this many frames in a row
+    static const int MAX_DEFERRED_FRAMES = 3;
+
+    PresentScheduler();
+    // The first window added is the primary; swap intervals are set here
+    void addWindow(Window* window);
+    // Marks the start of a frame; presentation latency is measured from here
+    void beginFrame();
+    void drawFrame(const SceneSnapshot& snapshot, int* state, std::vector<Renderer*>& allRenderers);
+    Clock::time_point getFrameStart() const { return frameStart; }
+    static double elapsedMs(Clock::time_point from, Clock::time_point to);
+    double getPeriodMs() const { return periodMs; }
+};
@@ -1,6 +1,7 @@
 
 #include "renderer.h"
 #include "window.h"
+#include "scenefile.h"
 #include <stdexcept>
 #include <string>
 #include <glm/gtc/matrix_transform.hpp>
@@ -9,52 +10,88 @@
 #include <imgui/backends/imgui_impl_sdl2.h>
 #include <algorithm>
 #include <iostream>
-#include <thread>
-#include <mutex>
-#include <queue>
 #include <glm/gtc/type_ptr.hpp>
 
+static const GLenum INSTANCE_DATA_UNIT = 1;
+static const GLenum INSTANCE_INDEX_UNIT = 2;
+static const GLuint LIGHTS_BINDING = 1;
+// Per-draw values are passed as the current value of a vertex attribute no
+// VAO enables. That value is context state, while uniforms belong to the
+// programs every context of the share group uses, possibly at the same time.
+static const GLuint INSTANCE_BASE_ATTRIBUTE = 3;
+
 static const char* defaultVertexShader = R"(
 #version 330 core
 layout (location = 0) in vec3 aPos;
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform samplerBuffer instanceData;     // Per slot: 4 texels of model matrix, color, light indices
+uniform usamplerBuffer instanceIndices; // Slots to draw, one run per draw call
+layout (location = 3) in int instanceBase;  // Constant: the run's first index
+layout (std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 cameraPosition;
+};
 out vec3 fragPos;
+out vec4 instanceColor;
+flat out ivec4 lightIndices;
 void main() {
-    fragPos = vec3(model * vec4(aPos, 1.0));
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    int slot = int(texelFetch(instanceIndices, instanceBase + gl_InstanceID).r);
+    int base = slot * 6;
+    mat4 model = mat4(texelFetch(instanceData, base),
+                      texelFetch(instanceData, base + 1),
+                      texelFetch(instanceData, base + 2),
+                      texelFetch(instanceData, base + 3));
+    instanceColor = texelFetch(instanceData, base + 4);
+    lightIndices = ivec4(texelFetch(instanceData, base + 5));
+    vec4 worldPos = model * vec4(aPos, 1.0);
+    fragPos = worldPos.xyz;
+    gl_Position = viewProjection * worldPos;
 }
 )";
 
 static const char* defaultFragmentShader = R"(
 #version 330 core
+#define MAX_LIGHTS 64
+struct Light {
+    vec4 position;  // w: cos(cutoff)
+    vec4 direction; // w: intensity
+    vec4 color;
+};
+layout (std140) uniform Lights {
+    Light lights[MAX_LIGHTS];
+};
 in vec3 fragPos;
+in vec4 instanceColor;
+flat in ivec4 lightIndices; // Lights reaching this object, -1 terminated
 out vec4 FragColor;
-uniform vec4 color;
-uniform vec3 lightPos;
-uniform vec3 lightDir;
-uniform vec4 lightColor;
-uniform float lightCutoff;
-uniform float lightIntensity;
 void main() {
-    vec3 lightDirNorm = normalize(lightDir);
-    float theta = dot(-lightDirNorm, normalize(fragPos - lightPos));
-    float cutoff = cos(radians(lightCutoff));
-    float lightEffect = lightIntensity * max(theta > cutoff ? theta : 0.0, 0.0);
-    FragColor = color * lightColor * (lightEffect + 0.1); // Ambient term
+    vec4 lighting = lights[0].color * 0.1; // Ambient term
+    for (int i = 0; i < 4; ++i) {
+        int index = lightIndices[i];
+        if (index < 0) break;
+        Light light = lights[index];
+        float theta = dot(-light.direction.xyz, normalize(fragPos - light.position.xyz));
+        float lightEffect = light.direction.w * max(theta > light.position.w ? theta : 0.0, 0.0);
+        lighting += light.color * lightEffect;
+    }
+    FragColor = vec4(instanceColor.rgb * lighting.rgb, instanceColor.a);
 }
 )";
 
 static const char* debugVertexShader = R"(
 #version 330 core
 layout (location = 0) in vec3 aPos;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 cameraPosition;
+};
+layout (location = 4) in vec4 color;     // Constant per draw
 out vec4 lineColor;
-uniform vec4 color;
 void main() {
-    gl_Position = projection * view * vec4(aPos, 1.0);
+    gl_Position = viewProjection * vec4(aPos, 1.0);
     lineColor = color;
 }
 )";
@@ -67,14 +104,21 @@ void main() {
     FragColor = lineColor;
 }
 )";
-Renderer::Renderer(const char* vertexShaderSource, const char* fragmentShaderSource) {
-    shaderProgram = 0;
-    debugShaderProgram = 0;
+Renderer::Renderer(const char* vertexShaderSource, const char* fragmentShaderSource, SDL_GLContext shareWith) {
+    context = SDL_GL_GetCurrentContext();
+    resources = SharedResources::acquire(context, shareWith);
+    geometryCache = &resources->getGeometryCache();
+    frameNumber = 0;
+    shaderProgram = nullptr;
+    debugShaderProgram = nullptr;
+    debugDraw = nullptr;
+    scene = nullptr;
+    instanceIndices = nullptr;
+    frameUniforms = nullptr;
     camera = nullptr;
-    selectedShape = nullptr;
-    selectedSpotlight = nullptr;
-    selectedGameCamera = nullptr; // Added
     lastFrameTime = std::chrono::high_resolution_clock::now();
+    counts = {0, 0, 0};
+    publishedCounts = counts;
     window = nullptr;
     type = WINDOW_MAIN;
     createShaderProgram(
@@ -82,81 +126,51 @@ Renderer::Renderer(const char* vertexShaderSource, const char* fragmentShaderSou
         fragmentShaderSource ? fragmentShaderSource : defaultFragmentShader
     );
     createDebugShaderProgram();
+    debugDraw = new DebugDraw();
+    debugDraw->init();
+    instanceIndices = new InstanceIndexStream();
+    instanceIndices->init();
+    frameUniforms = new FrameUniformBuffer();
+    frameUniforms->init();
+
+    // Uniform buffer bindings are context state; nothing else rebinds these points
+    frameUniforms->bind();
 }
 
+// The scene outlives its renderers; it is never owned by one
 Renderer::~Renderer() {
-    for (Shape* shape : shapes) {
-        delete shape;
-    }
-    shapes.clear();
-    for (Spotlight* light : spotlights) {
-        delete light;
-    }
-    spotlights.clear();
-    for (GameCamera* cam : gameCameras) { // Added
-        delete cam;
+    delete debugDraw;
+    delete instanceIndices;
+    delete frameUniforms;
+    for (auto& entry : vaos) {
+        glDeleteVertexArrays(1, &entry.second.vao);
     }
-    gameCameras.clear();
-    glDeleteProgram(shaderProgram);
-    glDeleteProgram(debugShaderProgram);
     delete camera;
-}
-
-void Renderer::compileShader(GLenum type, const char* source, GLuint& shader) {
-    shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, nullptr);
-    glCompileShader(shader);
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-        throw std::runtime_error("Shader compilation failed: " + std::string(infoLog));
-    }
+    resources->release(context);
 }
 
 void Renderer::createShaderProgram(const char* vertexSource, const char* fragmentSource) {
-    GLuint vertexShader, fragmentShader;
-    compileShader(GL_VERTEX_SHADER, vertexSource, vertexShader);
-    compileShader(GL_FRAGMENT_SHADER, fragmentSource, fragmentShader);
-
-    shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    GLint success;
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-        throw std::runtime_error("Shader program linking failed: " + std::string(infoLog));
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    shaderProgram = resources->getProgram(vertexSource, fragmentSource, "Shader");
+    uniforms.instanceData = shaderProgram->uniform<int>("instanceData");
+    uniforms.instanceIndices = shaderProgram->uniform<int>("instanceIndices");
+    shaderProgram->bindUniformBlock("Frame", FrameUniformBuffer::BINDING);
+    shaderProgram->bindUniformBlock("Lights", LIGHTS_BINDING);
+    // The program is shared by the group, so only values that never change are uniforms
+    shaderProgram->use();
+    uniforms.instanceData.set(INSTANCE_DATA_UNIT);
+    uniforms.instanceIndices.set(INSTANCE_INDEX_UNIT);
 }
 
 void Renderer::createDebugShaderProgram() {
-    GLuint vertexShader, fragmentShader;
-    compileShader(GL_VERTEX_SHADER, debugVertexShader, vertexShader);
-    compileShader(GL_FRAGMENT_SHADER, debugFragmentShader, fragmentShader);
-
-    debugShaderProgram = glCreateProgram();
-    glAttachShader(debugShaderProgram, vertexShader);
-    glAttachShader(debugShaderProgram, fragmentShader);
-    glLinkProgram(debugShaderProgram);
+    debugShaderProgram = resources->getProgram(debugVertexShader, debugFragmentShader, "Debug shader");
+    debugShaderProgram->bindUniformBlock("Frame", FrameUniformBuffer::BINDING);
+}
 
-    GLint success;
-    glGetProgramiv(debugShaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(debugShaderProgram, 512, nullptr, infoLog);
-        throw std::runtime_error("Debug shader program linking failed: " + std::string(infoLog));
+void Renderer::setScene(Scene* scene) {
+    this->scene = scene;
+    if (scene) {
+        scene->getLights().bind(LIGHTS_BINDING);
     }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
 }
 
 void Renderer::init() {
@@ -165,277 +179,160 @@ void Renderer::init() {
         camera->setAspect(1.0f);
     }
 
-    for (Shape* shape : shapes) {
-        try {
-            shape->init();
-        } catch (const std::exception& e) {
-            std::cerr << "Shape init failed: " << e.what() << std::endl;
-        }
-    }
-
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LESS);
 }
 
-void Renderer::render() {
+void Renderer::render(const SceneSnapshot& snapshot) {
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    // The size the window took for this frame; SDL itself is main-thread only
     if (window) {
-        int width, height;
-        SDL_GetWindowSize(window->GetWindow(), &width, &height);
-        glViewport(0, 0, width, height);
-        updateCameraAspect(static_cast<float>(width) / height);
+        glViewport(0, 0, window->GetWidth(), window->GetHeight());
+        updateCameraAspect(static_cast<float>(window->GetWidth()) / window->GetHeight());
     }
 
-    // Render shapes
-    glUseProgram(shaderProgram);
-
-    GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
-    GLint viewLoc = glGetUniformLocation(shaderProgram, "view");
-    GLint projLoc = glGetUniformLocation(shaderProgram, "projection");
+    if (snapshot.uploaded) {
+        glWaitSync(snapshot.uploaded, 0, GL_TIMEOUT_IGNORED);
+    }
 
+    // Render shapes; instance data was synced by Scene::update this frame
     glm::mat4 view = camera->getViewMatrix();
     glm::mat4 projection = camera->getProjectionMatrix();
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, &view[0][0]);
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, &projection[0][0]);
-
-    if (!spotlights.empty()) {
-        Spotlight* light = spotlights[0];
-        glUniform3fv(glGetUniformLocation(shaderProgram, "lightPos"), 1, &light->getPosition()[0]);
-        glUniform3fv(glGetUniformLocation(shaderProgram, "lightDir"), 1, &light->getDirection()[0]);
-        glUniform4fv(glGetUniformLocation(shaderProgram, "lightColor"), 1, &light->getColor()[0]);
-        glUniform1f(glGetUniformLocation(shaderProgram, "lightCutoff"), light->getCutoff());
-        glUniform1f(glGetUniformLocation(shaderProgram, "lightIntensity"), light->getIntensity());
-    } else {
-        glUniform3fv(glGetUniformLocation(shaderProgram, "lightPos"), 1, glm::value_ptr(glm::vec3(0.0f, 0.0f, 0.0f)));
-        glUniform3fv(glGetUniformLocation(shaderProgram, "lightDir"), 1, glm::value_ptr(glm::vec3(0.0f, 0.0f, -1.0f)));
-        glUniform4fv(glGetUniformLocation(shaderProgram, "lightColor"), 1, glm::value_ptr(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f)));
-        glUniform1f(glGetUniformLocation(shaderProgram, "lightCutoff"), 12.5f);
-        glUniform1f(glGetUniformLocation(shaderProgram, "lightIntensity"), 1.0f);
+    buildQueue(snapshot, view, Frustum(projection * view));
+    frameUniforms->update({view, projection, projection * view, glm::vec4(camera->getPosition(), 1.0f)});
+    shaderProgram->use();
+
+    // Rebinding also picks up instance data written through another context
+    snapshot.instances->bind(INSTANCE_DATA_UNIT);
+    instanceIndices->bind(INSTANCE_INDEX_UNIT);
+    // Runs are in key order, so state only changes at key boundaries
+    Geometry* boundGeometry = nullptr;
+    bool blending = false;
+    for (const DrawRun& run : drawRuns) {
+        if (run.transparent != blending) {
+            blending = run.transparent;
+            if (blending) {
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                glDepthMask(GL_FALSE);
+            } else {
+                glDisable(GL_BLEND);
+                glDepthMask(GL_TRUE);
+            }
+        }
+        if (run.geometry != boundGeometry) {
+            glBindVertexArray(getVao(run.geometry));
+            boundGeometry = run.geometry;
+        }
+        glVertexAttribI4i(INSTANCE_BASE_ATTRIBUTE, run.first, 0, 0, 0);
+        glDrawElementsInstanced(GL_TRIANGLES, run.geometry->indexCount, run.geometry->indexType, 0, run.count);
     }
-
-    for (Shape* shape : shapes) {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, shape->getPosition());
-        model = glm::rotate(model, glm::radians(shape->getRotation().x), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = glm::rotate(model, glm::radians(shape->getRotation().y), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::rotate(model, glm::radians(shape->getRotation().z), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, shape->getScale());
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, &model[0][0]);
-        glUniform4fv(glGetUniformLocation(shaderProgram, "color"), 1, &shape->getColor()[0]);
-        shape->draw(shaderProgram);
+    if (blending) {
+        glDisable(GL_BLEND);
+        glDepthMask(GL_TRUE);
     }
+    glBindVertexArray(0);
+    pruneVaos();
 
     // Render debug geometry (spotlight, game camera, grid, gizmo)
-    glUseProgram(debugShaderProgram);
-    GLint debugViewLoc = glGetUniformLocation(debugShaderProgram, "view");
-    GLint debugProjLoc = glGetUniformLocation(debugShaderProgram, "projection");
-    GLint debugColorLoc = glGetUniformLocation(debugShaderProgram, "color");
-    glUniformMatrix4fv(debugViewLoc, 1, GL_FALSE, &view[0][0]);
-    glUniformMatrix4fv(debugProjLoc, 1, GL_FALSE, &projection[0][0]);
-
-    // Spotlight direction (line)
-    if (!spotlights.empty()) {
-        Spotlight* light = spotlights[0];
-        glm::vec3 start = light->getPosition();
-        glm::vec3 end = start + light->getDirection() * 2.0f;
-        std::vector<float> vertices = {
-            start.x, start.y, start.z,
-            end.x, end.y, end.z
-        };
-        GLuint vao, vbo;
-        glGenVertexArrays(1, &vao);
-        glGenBuffers(1, &vbo);
-        glBindVertexArray(vao);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-        glUniform4f(debugColorLoc, 1.0f, 1.0f, 0.0f, 1.0f); // Yellow
-        glLineWidth(2.0f);
-        glDrawArrays(GL_LINES, 0, 2);
-        glLineWidth(1.0f);
-        glDeleteVertexArrays(1, &vao);
-        glDeleteBuffers(1, &vbo);
-    }
-
-    // Game camera direction (line)
-    if (selectedGameCamera) {
-        glm::vec3 start = selectedGameCamera->getPosition();
-        glm::vec3 end = start + selectedGameCamera->getForward() * 2.0f;
-        std::vector<float> vertices = {
-            start.x, start.y, start.z,
-            end.x, end.y, end.z
-        };
-        GLuint vao, vbo;
-        glGenVertexArrays(1, &vao);
-        glGenBuffers(1, &vbo);
-        glBindVertexArray(vao);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-        glUniform4f(debugColorLoc, 0.0f, 1.0f, 1.0f, 1.0f); // Cyan
-        glLineWidth(2.0f);
-        glDrawArrays(GL_LINES, 0, 2);
-        glLineWidth(1.0f);
-        glDeleteVertexArrays(1, &vao);
-        glDeleteBuffers(1, &vbo);
-    }
-
-    // Grid (XZ plane, 10x10 units, 1-unit spacing)
-    std::vector<float> gridVertices;
-    for (int i = -5; i <= 5; ++i) {
-        gridVertices.insert(gridVertices.end(), {
-            (float)i, 0.0f, -5.0f,
-            (float)i, 0.0f, 5.0f,
-            -5.0f, 0.0f, (float)i,
-            5.0f, 0.0f, (float)i
-        });
-    }
-    GLuint gridVao, gridVbo;
-    glGenVertexArrays(1, &gridVao);
-    glGenBuffers(1, &gridVbo);
-    glBindVertexArray(gridVao);
-    glBindBuffer(GL_ARRAY_BUFFER, gridVbo);
-    glBufferData(GL_ARRAY_BUFFER, gridVertices.size() * sizeof(float), gridVertices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glUniform4f(debugColorLoc, 0.5f, 0.5f, 0.5f, 1.0f); // Gray
-    glLineWidth(1.0f);
-    glDrawArrays(GL_LINES, 0, gridVertices.size() / 3);
-    glDeleteVertexArrays(1, &gridVao);
-    glDeleteBuffers(1, &gridVbo);
-
-    // Gizmo (RGB axes at origin, 2 units long, with arrowheads)
-    std::vector<float> gizmoVertices = {
-        // X-axis (red)
-        0.0f, 0.0f, 0.0f, 2.0f, 0.0f, 0.0f, // Main line
-        2.0f, 0.0f, 0.0f, 1.8f, 0.1f, 0.0f, // Arrowhead
-        2.0f, 0.0f, 0.0f, 1.8f, -0.1f, 0.0f,
-        2.0f, 0.0f, 0.0f, 1.8f, 0.0f, 0.1f,
-        2.0f, 0.0f, 0.0f, 1.8f, 0.0f, -0.1f,
-        // Y-axis (green)
-        0.0f, 0.0f, 0.0f, 0.0f, 2.0f, 0.0f,
-        0.0f, 2.0f, 0.0f, 0.1f, 1.8f, 0.0f,
-        0.0f, 2.0f, 0.0f, -0.1f, 1.8f, 0.0f,
-        0.0f, 2.0f, 0.0f, 0.0f, 1.8f, 0.1f,
-        0.0f, 2.0f, 0.0f, 0.0f, 1.8f, -0.1f,
-        // Z-axis (blue)
-        0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 2.0f,
-        0.0f, 0.0f, 2.0f, 0.1f, 0.0f, 1.8f,
-        0.0f, 0.0f, 2.0f, -0.1f, 0.0f, 1.8f,
-        0.0f, 0.0f, 2.0f, 0.0f, 0.1f, 1.8f,
-        0.0f, 0.0f, 2.0f, 0.0f, -0.1f, 1.8f
-    };
-    GLuint gizmoVao, gizmoVbo;
-    glGenVertexArrays(1, &gizmoVao);
-    glGenBuffers(1, &gizmoVbo);
-    glBindVertexArray(gizmoVao);
-    glBindBuffer(GL_ARRAY_BUFFER, gizmoVbo);
-    glBufferData(GL_ARRAY_BUFFER, gizmoVertices.size() * sizeof(float), gizmoVertices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glLineWidth(3.0f); // Thicker lines
-    glUniform4f(debugColorLoc, 1.0f, 0.0f, 0.0f, 1.0f); // Red (X)
-    glDrawArrays(GL_LINES, 0, 2); // Main X
-    glDrawArrays(GL_LINES, 2, 4); // X arrowhead
-    glUniform4f(debugColorLoc, 0.0f, 1.0f, 0.0f, 1.0f); // Green (Y)
-    glDrawArrays(GL_LINES, 6, 2); // Main Y
-    glDrawArrays(GL_LINES, 8, 4); // Y arrowhead
-    glUniform4f(debugColorLoc, 0.0f, 0.0f, 1.0f, 1.0f); // Blue (Z)
-    glDrawArrays(GL_LINES, 12, 2); // Main Z
-    glDrawArrays(GL_LINES, 14, 4); // Z arrowhead
-    glLineWidth(1.0f);
-    glDeleteVertexArrays(1, &gizmoVao);
-    glDeleteBuffers(1, &gizmoVbo);
+    debugShaderProgram->use();
+
+    // Spotlight and game camera directions (lines)
+    for (const SceneSnapshot::Line& line : snapshot.lines) {
+        debugDraw->line(line.start, line.end, line.color, 2.0f);
+    }
+
+    debugDraw->flush();
+    debugDraw->drawGrid();
+    debugDraw->drawGizmo();
+    glBindVertexArray(0);
 }
 
-void Renderer::loadFromJSON(const nlohmann::json& json) {
-    if (json.contains("shapes") && json["shapes"].is_array()) {
-        for (const auto& shapeJson : json["shapes"]) {
-            if (shapeJson.contains("type") && shapeJson["type"].is_string()) {
-                std::string shapeType = shapeJson["type"].get<std::string>();
-                Shape* shape = nullptr;
-                if (shapeType == "Mesh" && shapeJson.contains("objPath") && shapeJson["objPath"].is_string()) {
-                    shape = new Mesh(shapeJson["objPath"].get<std::string>());
-                } else {
-                    shape = Shape::createShape(shapeType);
-                }
-                if (shape) {
-                    try {
-                        if (shapeJson.contains("position") && shapeJson["position"].is_array()) {
-                            auto pos = shapeJson["position"].get<std::vector<float>>();
-                            if (pos.size() == 3) shape->setPosition({pos[0], pos[1], pos[2]});
-                        }
-                        if (shapeJson.contains("scale") && shapeJson["scale"].is_array()) {
-                            auto scl = shapeJson["scale"].get<std::vector<float>>();
-                            if (scl.size() == 3) shape->setScale({scl[0], scl[1], scl[2]});
-                        }
-                        if (shapeJson.contains("rotation") && shapeJson["rotation"].is_array()) {
-                            auto rot = shapeJson["rotation"].get<std::vector<float>>();
-                            if (rot.size() == 3) shape->setRotation({rot[0], rot[1], rot[2]});
-                        }
-                        if (shapeJson.contains("color") && shapeJson["color"].is_array()) {
-                            auto col = shapeJson["color"].get<std::vector<float>>();
-                            if (col.size() == 4) shape->setColor({col[0], col[1], col[2], col[3]});
-                        }
-                        shape->init();
-                        shapes.push_back(shape);
-                    } catch (const std::exception& e) {
-                        std::cerr << "Failed to initialize shape: " << e.what() << std::endl;
-                        delete shape;
-                    }
-                }
-            }
-        }
+// Vertex arrays cannot be shared between contexts, so each renderer keeps
+// its own per geometry, keyed by the geometry's never-reused id.
+GLuint Renderer::getVao(const Geometry* geometry) {
+    auto it = vaos.find(geometry->id);
+    if (it == vaos.end()) {
+        it = vaos.emplace(geometry->id, VaoEntry{geometry->createVao(), 0}).first;
     }
-    if (json.contains("spotlights") && json["spotlights"].is_array()) {
-        for (const auto& lightJson : json["spotlights"]) {
-            if (lightJson.contains("name") && lightJson["name"].is_string()) {
-                Spotlight* light = new Spotlight(lightJson["name"].get<std::string>());
-                if (lightJson.contains("position") && lightJson["position"].is_array()) {
-                    auto pos = lightJson["position"].get<std::vector<float>>();
-                    if (pos.size() == 3) light->setPosition({pos[0], pos[1], pos[2]});
-                }
-                if (lightJson.contains("direction") && lightJson["direction"].is_array()) {
-                    auto dir = lightJson["direction"].get<std::vector<float>>();
-                    if (dir.size() == 3) light->setDirection({dir[0], dir[1], dir[2]});
-                }
-                if (lightJson.contains("color") && lightJson["color"].is_array()) {
-                    auto col = lightJson["color"].get<std::vector<float>>();
-                    if (col.size() == 4) light->setColor({col[0], col[1], col[2], col[3]});
-                }
-                if (lightJson.contains("cutoff") && lightJson["cutoff"].is_number_float()) {
-                    light->setCutoff(lightJson["cutoff"].get<float>());
-                }
-                if (lightJson.contains("intensity") && lightJson["intensity"].is_number_float()) {
-                    light->setIntensity(lightJson["intensity"].get<float>());
-                }
-                spotlights.push_back(light);
-            }
+    it->second.lastFrame = frameNumber;
+    return it->second.vao;
+}
+
+// Once some cached geometry has been freed, drops the vertex arrays not used
+// this frame; still-live ones are simply rebuilt when next drawn.
+void Renderer::pruneVaos() {
+    ++frameNumber;
+    if (vaos.size() <= geometryCache->size()) return;
+    for (auto it = vaos.begin(); it != vaos.end();) {
+        if (it->second.lastFrame != frameNumber - 1) {
+            glDeleteVertexArrays(1, &it->second.vao);
+            it = vaos.erase(it);
+        } else {
+            ++it;
         }
     }
-    if (json.contains("gameCameras") && json["gameCameras"].is_array()) { // Added
-        for (const auto& camJson : json["gameCameras"]) {
-            if (camJson.contains("name") && camJson["name"].is_string()) {
-                GameCamera* cam = new GameCamera(camJson["name"].get<std::string>());
-                if (camJson.contains("position") && camJson["position"].is_array()) {
-                    auto pos = camJson["position"].get<std::vector<float>>();
-                    if (pos.size() == 3) cam->setPosition({pos[0], pos[1], pos[2]});
-                }
-                if (camJson.contains("rotation") && camJson["rotation"].is_array()) {
-                    auto rot = camJson["rotation"].get<std::vector<float>>();
-                    if (rot.size() == 3) cam->setRotation({rot[0], rot[1], rot[2]});
-                }
-                if (camJson.contains("fov") && camJson["fov"].is_number_float()) {
-                    cam->setFov(camJson["fov"].get<float>());
-                }
-                gameCameras.push_back(cam);
-            }
+}
+
+// Queues a draw packet for each shape visible from this view
+void Renderer::buildQueue(const SceneSnapshot& snapshot, const glm::mat4& view, const Frustum& frustum) {
+    size_t visible = 0;
+    size_t culled = 0;
+    renderQueue.clear();
+    geometryIds.clear();
+    geometryTable.clear();
+    float nearPlane = camera->getNear();
+    float depthRange = camera->getFar() - nearPlane;
+
+    for (const SceneSnapshot::Item& item : snapshot.items) {
+        Geometry* geometry = item.geometry;
+        const Bounds& bounds = item.bounds;
+        if (!frustum.intersects(bounds)) {
+            ++culled;
+            continue;
+        }
+        ++visible;
+
+        auto it = geometryIds.find(geometry);
+        if (it == geometryIds.end()) {
+            it = geometryIds.emplace(geometry, geometryTable.size()).first;
+            geometryTable.push_back(geometry);
+        }
+        float depth = (-(view * glm::vec4(bounds.center, 1.0f)).z - nearPlane) / depthRange;
+        uint64_t key = item.transparent
+            ? RenderQueue::transparentKey(0, it->second, depth)
+            : RenderQueue::opaqueKey(0, it->second, depth);
+        renderQueue.push(key, item.slot, it->second);
+    }
+    counts.visible = visible;
+    counts.culled = culled;
+    buildDrawRuns();
+}
+
+// Sorts the queue and collapses it into runs of packets that share program,
+// blend state and geometry; each run becomes one instanced draw.
+void Renderer::buildDrawRuns() {
+    renderQueue.sort();
+    drawIndices.clear();
+    drawRuns.clear();
+
+    const std::vector<DrawPacket>& packets = renderQueue.getPackets();
+    for (size_t i = 0; i < packets.size(); ++i) {
+        const DrawPacket& packet = packets[i];
+        if (i == 0 || packet.geometry != packets[i - 1].geometry || (packet.key >> 56) != (packets[i - 1].key >> 56)) {
+            drawRuns.push_back({geometryTable[packet.geometry], (GLint)i, 0, RenderQueue::isTransparent(packet.key)});
         }
+        ++drawRuns.back().count;
+        drawIndices.push_back(packet.slot);
     }
+    instanceIndices->upload(drawIndices);
+    counts.drawCalls = drawRuns.size();
+}
+
+// Entities belong to the Scene; a view only loads its camera
+void Renderer::loadFromJSON(const nlohmann::json& json) {
     if (json.contains("camera") && json["camera"].is_object()) {
         if (!camera) camera = new Camera();
         auto camJson = json["camera"];
@@ -473,6 +370,21 @@ void Renderer::renderImGui(bool isDebugWindow, float fps, std::vector<Renderer*>
 
     ImGui::Begin(isDebugWindow ? "Debug Window" : "Renderer Controls");
     ImGui::Text("FPS: %.1f", fps);
+    if (isDebugWindow) {
+        for (size_t i = 0; i < allRenderers.size(); ++i) {
+            ImGui::Text("View %zu: %zu visible, %zu culled, %zu draws", i, allRenderers[i]->getVisibleCount(),
+                        allRenderers[i]->getCulledCount(), allRenderers[i]->getDrawCallCount());
+            if (Window* view = allRenderers[i]->GetWindow()) {
+                const PresentStats& stats = view->GetPresentStats();
+                ImGui::Text("  draw %.2f ms, present latency %.2f ms, %llu deferred", stats.drawMs, stats.latencyMs,
+                            (unsigned long long)stats.deferredFrames);
+            }
+        }
+    }
+    if (!scene) {
+        ImGui::End();
+        return;
+    }
 
     // Shape selection combo
     static int currentShape = 0;
@@ -489,93 +401,87 @@ void Renderer::renderImGui(bool isDebugWindow, float fps, std::vector<Renderer*>
         std::string path = (currentShape == 3) ? objPath : "";
         std::cout << "Adding " << shapeType << (path.empty() ? "" : " with path " + path) << std::endl;
 
-        std::thread([this, shapeType, path]() {
-            Shape* newShape = (shapeType == "Mesh") ? new Mesh(path) : Shape::createShape(shapeType);
-            if (newShape) {
-                std::lock_guard<std::mutex> lock(shapeMutex);
-                pendingShapes.push(newShape);
-            } else {
-                std::cerr << "Failed to create shape: " << shapeType << std::endl;
-            }
-        }).detach();
+        if (shapeType == "Mesh") {
+            scene->loadMesh(path);
+        } else if (!scene->queueShape(shapeType)) {
+            std::cerr << "Failed to create shape: " << shapeType << std::endl;
+        }
+    }
+
+    // Meshes still loading, with their upload progress
+    for (const AssetLoader::Progress& load : scene->getAssetLoader().getProgress()) {
+        ImGui::PushID((int)load.id);
+        const char* label = load.state == AssetLoader::State::Queued ? "queued"
+                          : load.state == AssetLoader::State::Uploading ? nullptr : "loading";
+        ImGui::ProgressBar(load.uploaded, ImVec2(100.0f, 0.0f), label);
+        ImGui::SameLine();
+        ImGui::Text("%s", load.path.c_str());
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Cancel")) {
+            scene->getAssetLoader().cancel(load.id);
+        }
+        ImGui::PopID();
     }
 
     // Add spotlight button
     static char lightName[256] = "Spotlight";
     ImGui::InputText("Spotlight Name", lightName, IM_ARRAYSIZE(lightName));
     if (ImGui::Button("Add Spotlight")) {
-        spotlights.push_back(new Spotlight(lightName));
+        scene->addSpotlight(lightName);
     }
 
     // Add game camera button
     static char camName[256] = "GameCamera";
     ImGui::InputText("Game Camera Name", camName, IM_ARRAYSIZE(camName));
     if (ImGui::Button("Add Game Camera")) {
-        gameCameras.push_back(new GameCamera(camName));
+        scene->addGameCamera(camName);
     }
 
+    // Deletions and resets take effect at the next Scene::update, so every
+    // view draws the same entities this frame
+    Shape* selectedShape = scene->getSelectedShape();
+    Spotlight* selectedSpotlight = scene->getSelectedSpotlight();
+    GameCamera* selectedGameCamera = scene->getSelectedGameCamera();
+    const std::vector<Shape*>& shapes = scene->getShapes();
+    const std::vector<Spotlight*>& spotlights = scene->getSpotlights();
+    const std::vector<GameCamera*>& gameCameras = scene->getGameCameras();
+
     // Delete selected shape
     if (selectedShape && ImGui::Button("Delete Selected Shape")) {
-        auto it = std::find(shapes.begin(), shapes.end(), selectedShape);
-        if (it != shapes.end()) {
-            delete *it;
-            shapes.erase(it);
-            selectedShape = nullptr;
-        }
+        scene->removeShape(selectedShape);
+        selectedShape = nullptr;
     }
 
     // Delete selected spotlight
     if (selectedSpotlight && ImGui::Button("Delete Selected Spotlight")) {
-        auto it = std::find(spotlights.begin(), spotlights.end(), selectedSpotlight);
-        if (it != spotlights.end()) {
-            delete *it;
-            spotlights.erase(it);
-            selectedSpotlight = nullptr;
-        }
+        scene->removeSpotlight(selectedSpotlight);
+        selectedSpotlight = nullptr;
     }
 
     // Delete selected game camera
     if (selectedGameCamera && ImGui::Button("Delete Selected Game Camera")) {
-        auto it = std::find(gameCameras.begin(), gameCameras.end(), selectedGameCamera);
-        if (it != gameCameras.end()) {
-            delete *it;
-            gameCameras.erase(it);
-            selectedGameCamera = nullptr;
-        }
+        scene->removeGameCamera(selectedGameCamera);
+        selectedGameCamera = nullptr;
     }
 
     // Reset scene
     if (ImGui::Button("Reset Scene")) {
-        for (Shape* shape : shapes) {
-            delete shape;
-        }
-        shapes.clear();
-        for (Spotlight* light : spotlights) {
-            delete light;
-        }
-        spotlights.clear();
-        for (GameCamera* cam : gameCameras) {
-            delete cam;
-        }
-        gameCameras.clear();
+        scene->clear();
         selectedShape = nullptr;
         selectedSpotlight = nullptr;
         selectedGameCamera = nullptr;
     }
 
-    // Process pending shapes
-    {
-        std::lock_guard<std::mutex> lock(shapeMutex);
-        while (!pendingShapes.empty()) {
-            Shape* newShape = pendingShapes.front();
-            pendingShapes.pop();
-            try {
-                newShape->init();
-                shapes.push_back(newShape);
-            } catch (const std::exception& e) {
-                std::cerr << "Failed to initialize shape: " << e.what() << std::endl;
-                delete newShape;
-            }
+    // Save a binary snapshot, loaded at the next startup in place of scene.json
+    if (ImGui::Button("Save Scene")) {
+        std::vector<nlohmann::json> windowSettings;
+        for (Renderer* view : allRenderers) {
+            if (view->GetWindow()) windowSettings.push_back(view->GetWindow()->ToJSON());
+        }
+        if (windowSettings.empty()) windowSettings.push_back(window->ToJSON());
+        if (SceneFile::write(SceneFile::DEFAULT_PATH, windowSettings, scene->getShapeStore(),
+                             scene->getSpotlightStore(), scene->getGameCameraStore())) {
+            std::cout << "Saved scene to " << SceneFile::DEFAULT_PATH << std::endl;
         }
     }
 
@@ -583,7 +489,8 @@ void Renderer::renderImGui(bool isDebugWindow, float fps, std::vector<Renderer*>
     if (ImGui::CollapsingHeader("Shapes")) {
         for (size_t i = 0; i < shapes.size(); ++i) {
             ImGui::PushID(i);
-            if (ImGui::Selectable(shapes[i]->getType().c_str(), selectedShape == shapes[i])) {
+            std::string label = shapes[i]->getType() + " #" + std::to_string(i);
+            if (ImGui::Selectable(label.c_str(), selectedShape == shapes[i])) {
                 selectedShape = shapes[i];
                 selectedSpotlight = nullptr;
                 selectedGameCamera = nullptr;
@@ -618,6 +525,10 @@ void Renderer::renderImGui(bool isDebugWindow, float fps, std::vector<Renderer*>
         }
     }
 
+    scene->setSelectedShape(selectedShape);
+    scene->setSelectedSpotlight(selectedSpotlight);
+    scene->setSelectedGameCamera(selectedGameCamera);
+
     // Shape properties panel
     if (selectedShape) {
         ImGui::Begin("Shape Properties");
@@ -626,6 +537,16 @@ void Renderer::renderImGui(bool isDebugWindow, float fps, std::vector<Renderer*>
             ImGui::Text("OBJ Path: %s", dynamic_cast<Mesh*>(selectedShape)->getObjPath().c_str());
         }
 
+        // Parent by the #id in the shape list, -1 for none; transforms are relative to it
+        Shape* parent = selectedShape->getParent();
+        int parentId = parent ? (int)parent->getId() : -1;
+        if (ImGui::InputInt("Parent", &parentId)) {
+            Shape* newParent = parentId >= 0 && parentId < (int)shapes.size() ? shapes[parentId] : nullptr;
+            if (!selectedShape->setParent(newParent)) {
+                std::cerr << "A shape cannot be parented to itself or its descendants" << std::endl;
+            }
+        }
+
         glm::vec3 pos = selectedShape->getPosition();
         if (ImGui::DragFloat3("Position", &pos[0], 0.1f)) {
             selectedShape->setPosition(pos);
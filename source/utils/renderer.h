@@ -3,61 +3,98 @@
 
 #include <vector>
 #include <glad/glad.h>
-#include "shape.h"
-#include "mesh.h"
-#include "spotlight.h"
 #include "camera.h"
-#include "gamecamera.h" // Added
+#include "scene.h"
+#include "debugdraw.h"
+#include "shaderprogram.h"
+#include "instancebuffer.h"
+#include "lightbuffer.h"
+#include "renderqueue.h"
+#include "frameuniforms.h"
+#include "sharedresources.h"
 #include "window.h"
 #include "nlohmann/json.hpp"
 #include <chrono>
 #include <imgui/imgui.h>
 #include <imgui/backends/imgui_impl_opengl3.h>
-#include <mutex>
-#include <queue>
+#include <unordered_map>
 
 // Forward declaration of Window
 class Window;
 
+// One view of a Scene: a camera, view settings and the per-context GL state
+// needed to draw the scene into its window.
 class Renderer {
 private:
-    void compileShader(GLenum type, const char* source, GLuint& shader);
+    struct SceneUniforms {
+        Uniform<int> instanceData, instanceIndices;
+    };
+
+    // Consecutive queue packets drawn with a single instanced call
+    struct DrawRun {
+        Geometry* geometry;
+        GLint first;               // Offset of this run's slots in drawIndices
+        GLsizei count;
+        bool transparent;
+    };
+
     void createShaderProgram(const char* vertexSource, const char* fragmentSource);
     void createDebugShaderProgram();
-    GLuint shaderProgram;
-    GLuint debugShaderProgram;
-    std::vector<Shape*> shapes;
-    std::vector<Spotlight*> spotlights;
-    std::vector<GameCamera*> gameCameras; // Added
+    ShaderProgram* shaderProgram;
+    ShaderProgram* debugShaderProgram;
+    SceneUniforms uniforms;
+    Scene* scene;
+    InstanceIndexStream* instanceIndices;
+    FrameUniformBuffer* frameUniforms;
+    SDL_GLContext context;
+    SharedResources* resources;
+    GeometryCache* geometryCache;  // Owned by resources
+    struct VaoEntry {
+        GLuint vao;
+        uint64_t lastFrame;
+    };
+    std::unordered_map<uint64_t, VaoEntry> vaos; // Per-context vertex arrays by geometry id
+    uint64_t frameNumber;
+    GLuint getVao(const Geometry* geometry);
+    void pruneVaos();
+    RenderQueue renderQueue;
+    std::unordered_map<Geometry*, uint32_t> geometryIds; // Per-frame index into geometryTable
+    std::vector<Geometry*> geometryTable;
+    std::vector<DrawRun> drawRuns;
+    std::vector<GLuint> drawIndices;
+    void buildQueue(const SceneSnapshot& snapshot, const glm::mat4& view, const Frustum& frustum);
+    void buildDrawRuns();
+    DebugDraw* debugDraw;
     Camera* camera;
-    Shape* selectedShape;
-    Spotlight* selectedSpotlight;
-    GameCamera* selectedGameCamera; // Added
     mutable std::chrono::high_resolution_clock::time_point lastFrameTime;
-    std::mutex shapeMutex;
-    std::queue<Shape*> pendingShapes;
+    struct FrameCounts {
+        size_t visible, culled, drawCalls;
+    };
+    FrameCounts counts;             // Written while drawing, possibly on a render thread
+    FrameCounts publishedCounts;    // Copied by publishCounts(), read by the getters
 
 public:
     Window* window;
     WindowType type;
-    Renderer(const char* vertexShaderSource = nullptr, const char* fragmentShaderSource = nullptr);
+    Renderer(const char* vertexShaderSource = nullptr, const char* fragmentShaderSource = nullptr, SDL_GLContext shareWith = nullptr);
     ~Renderer();
     void init();
-    void render();
+    void render(const SceneSnapshot& snapshot);
     void loadFromJSON(const nlohmann::json& json);
     void setupImGui();
     void renderImGui(bool isDebugWindow, float fps, std::vector<Renderer*>& allRenderers);
     float getFPS() const;
-    std::vector<Shape*>& getShapes() { return shapes; }
-    std::vector<Spotlight*>& getSpotlights() { return spotlights; }
-    std::vector<GameCamera*>& getGameCameras() { return gameCameras; } // Added
-    Shape* getSelectedShape() const { return selectedShape; }
-    void setSelectedShape(Shape* shape) { selectedShape = shape; }
-    Spotlight* getSelectedSpotlight() const { return selectedSpotlight; }
-    void setSelectedSpotlight(Spotlight* light) { selectedSpotlight = light; }
-    GameCamera* getSelectedGameCamera() const { return selectedGameCamera; } // Added
-    void setSelectedGameCamera(GameCamera* cam) { selectedGameCamera = cam; } // Added
+    // Call on the main thread once the frame is drawn; the getters return
+    // the published counts, so the UI never reads ones a thread is writing
+    void publishCounts() { publishedCounts = counts; }
+    size_t getVisibleCount() const { return publishedCounts.visible; }
+    size_t getCulledCount() const { return publishedCounts.culled; }
+    size_t getDrawCallCount() const { return publishedCounts.drawCalls; }
+    SharedResources* getResources() const { return resources; }
+    void setScene(Scene* scene);
+    Scene* getScene() const { return scene; }
     void updateCameraAspect(float aspect);
+    const Camera* getCamera() const { return camera; }
     void SetType(WindowType tp) { type = tp; }
     void SetWindow(Window* wm) { window = wm; }
     Window* GetWindow() const { return window; }
@@ -0,0 +1,48 @@
+#include "renderqueue.h"
+#include <algorithm>
+
+// Depth in [0, 1] from the near to the far plane, quantized to 24 bits
+static uint64_t quantizeDepth(float depth) {
+    depth = std::min(std::max(depth, 0.0f), 1.0f);
+    return (uint64_t)(depth * 16777215.0f);
+}
+
+uint64_t RenderQueue::opaqueKey(uint32_t program, uint32_t geometry, float depth) {
+    return ((uint64_t)(program & 0x7f) << 56) |
+           ((uint64_t)(geometry & 0xffff) << 40) |
+           (quantizeDepth(depth) << 16);
+}
+
+uint64_t RenderQueue::transparentKey(uint32_t program, uint32_t geometry, float depth) {
+    return TRANSPARENT_BIT |
+           ((uint64_t)(program & 0x7f) << 56) |
+           ((0xffffffull - quantizeDepth(depth)) << 32) |
+           ((uint64_t)(geometry & 0xffff) << 16);
+}
+
+// LSD radix sort, one byte per pass. Passes where every key has the same
+// byte (e.g. the unused low 16 bits) are skipped.
+void RenderQueue::sort() {
+    if (packets.size() < 2) return;
+    scratch.resize(packets.size());
+
+    for (int pass = 0; pass < 8; ++pass) {
+        int shift = pass * 8;
+        size_t counts[256] = {};
+        for (const DrawPacket& packet : packets) {
+            ++counts[(packet.key >> shift) & 0xff];
+        }
+        if (counts[(packets[0].key >> shift) & 0xff] == packets.size()) continue;
+
+        size_t offset = 0;
+        for (size_t& count : counts) {
+            size_t c = count;
+            count = offset;
+            offset += c;
+        }
+        for (const DrawPacket& packet : packets) {
+            scratch[counts[(packet.key >> shift) & 0xff]++] = packet;
+        }
+        packets.swap(scratch);
+    }
+}
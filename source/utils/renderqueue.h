@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// One visible object: where its instance data lives and which geometry it uses.
+struct DrawPacket {
+    uint64_t key;
+    uint32_t slot;
+    uint32_t geometry; // Index into the renderer's per-frame geometry table
+};
+
+// Per-frame list of draw packets ordered by 64-bit sort key.
+//
+// Key layout, most significant bit first:
+//   opaque:      0 | program:7 | geometry:16 | depth:24 (near to far) | 0:16
+//   transparent: 1 | program:7 | ~depth:24 (far to near) | geometry:16 | 0:16
+// Opaque packets sharing a program and geometry end up adjacent, so they
+// collapse into one instanced draw; transparent ones stay back-to-front.
+class RenderQueue {
+private:
+    std::vector<DrawPacket> packets;
+    std::vector<DrawPacket> scratch;
+
+public:
+    static const uint64_t TRANSPARENT_BIT = 1ull << 63;
+    static uint64_t opaqueKey(uint32_t program, uint32_t geometry, float depth);
+    static uint64_t transparentKey(uint32_t program, uint32_t geometry, float depth);
+    static bool isTransparent(uint64_t key) { return (key & TRANSPARENT_BIT) != 0; }
+    static uint32_t programOf(uint64_t key) { return (key >> 56) & 0x7f; }
+
+    void clear() { packets.clear(); }
+    void push(uint64_t key, uint32_t slot, uint32_t geometry) { packets.push_back({key, slot, geometry}); }
+    void sort();
+    const std::vector<DrawPacket>& getPackets() const { return packets; }
+    size_t size() const { return packets.size(); }
+};
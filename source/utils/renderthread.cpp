@@ -0,0 +1,91 @@
+#include "renderthread.h"
+#include "renderer.h"
+#include <iostream>
+
+RenderThread::RenderThread(Window* window)
+    : window(window), snapshot(nullptr), submittedFrames(0), completedFrames(0), stopping(false),
+      drawn(nullptr), drawMs(0.0), latencyMs(0.0), timed(false) {
+    thread = std::thread(&RenderThread::run, this);
+}
+
+RenderThread::~RenderThread() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return completedFrames == submittedFrames; });
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+    if (drawn) {
+        glDeleteSync(drawn);
+    }
+}
+
+void RenderThread::submit(const SceneSnapshot* snapshot, Clock::time_point frameStart) {
+    window->SampleSize();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->snapshot = snapshot;
+        this->frameStart = frameStart;
+        ++submittedFrames;
+    }
+    wake.notify_one();
+}
+
+void RenderThread::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return completedFrames == submittedFrames; });
+    if (drawn) {
+        glWaitSync(drawn, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(drawn);
+        drawn = nullptr;
+    }
+    if (timed) {
+        window->GetPresentStats().record(drawMs, latencyMs);
+        timed = false;
+    }
+    window->renderer->publishCounts();
+}
+
+void RenderThread::run() {
+    if (SDL_GL_MakeCurrent(window->GetWindow(), window->GetGLContext()) < 0) {
+        std::cerr << "Render thread failed to make GL context current: " << SDL_GetError() << std::endl;
+    }
+
+    std::vector<Renderer*> noRenderers; // Only ImGui panels list the other views
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || submittedFrames > completedFrames; });
+        if (stopping) break;
+        const SceneSnapshot* frame = snapshot;
+        Clock::time_point start = frameStart;
+        lock.unlock();
+
+        GLsync fence = nullptr;
+        double frameDrawMs = 0.0, frameLatencyMs = 0.0;
+        try {
+            int state = 1;
+            Clock::time_point drawStart = Clock::now();
+            window->Draw(*frame, &state, noRenderers);
+            Clock::time_point drawEnd = Clock::now();
+            window->Present();
+            fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+            frameDrawMs = PresentScheduler::elapsedMs(drawStart, drawEnd);
+            frameLatencyMs = PresentScheduler::elapsedMs(start, Clock::now());
+        } catch (const std::exception& e) {
+            std::cerr << "Render thread error: " << e.what() << std::endl;
+        }
+
+        lock.lock();
+        drawn = fence;
+        drawMs = frameDrawMs;
+        latencyMs = frameLatencyMs;
+        timed = fence != nullptr;
+        ++completedFrames;
+        finished.notify_all();
+    }
+    lock.unlock();
+
+    SDL_GL_MakeCurrent(window->GetWindow(), nullptr);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <glad/glad.h>
+#include "window.h"
+#include "presentscheduler.h"
+
+// Draws and presents one window on its own thread, with the window's GL
+// context current there for the thread's whole life. Frames are handed
+// over in lockstep: submit() publishes a snapshot with the window size
+// sampled on the main thread, and wait() returns once the thread has
+// presented it, publishing its timings and counts, so the main thread may
+// then change the scene again.
+class RenderThread {
+private:
+    using Clock = PresentScheduler::Clock;
+
+    Window* window;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const SceneSnapshot* snapshot;
+    Clock::time_point frameStart;
+    uint64_t submittedFrames;
+    uint64_t completedFrames;
+    bool stopping;
+    GLsync drawn;              // Fences the last frame's draws against the next scene update
+    double drawMs, latencyMs;  // Last frame's timings, recorded into the window by wait()
+    bool timed;
+
+    void run();
+
+public:
+    // The window's context must not be current on any other thread
+    RenderThread(Window* window);
+    // Finishes the frame in flight, then releases the context
+    ~RenderThread();
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // snapshot must stay untouched until wait() returns
+    void submit(const SceneSnapshot* snapshot, Clock::time_point frameStart);
+    // Blocks until the submitted frame is presented, and makes the calling
+    // thread's context wait for its draws. Call from the main thread.
+    void wait();
+};
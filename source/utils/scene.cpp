@@ -0,0 +1,223 @@
+#include "scene.h"
+#include <algorithm>
+#include <iostream>
+
+template<typename T>
+static void clearIfRemoved(T*& selected, const std::vector<T*>& removed) {
+    if (std::find(removed.begin(), removed.end(), selected) != removed.end()) {
+        selected = nullptr;
+    }
+}
+
+Scene::Scene(GeometryCache& geometryCache)
+    : selectedShape(nullptr), selectedSpotlight(nullptr), selectedGameCamera(nullptr),
+      geometryCache(&geometryCache), assetLoader(nullptr), instances(nullptr), lightBuffer(nullptr), frameNumber(0) {
+    assetLoader = new AssetLoader(geometryCache);
+    instances = new InstanceBuffer();
+    instances->init();
+    lightBuffer = new LightBuffer();
+    lightBuffer->init();
+}
+
+Scene::~Scene() {
+    delete assetLoader;
+    // Releases geometry while the context is still current
+    pendingShapes.clear();
+    shapes.clear();
+    spotlights.clear();
+    gameCameras.clear();
+    delete instances;
+    delete lightBuffer;
+}
+
+// Initializes every shape of store and deletes the ones that fail
+static void initShapes(ShapeStore& store, GeometryCache& cache) {
+    std::vector<Shape*> failed;
+    for (Shape* shape : store.getViews()) {
+        try {
+            shape->init(cache);
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to initialize shape: " << e.what() << std::endl;
+            failed.push_back(shape);
+        }
+    }
+    store.erase(failed);
+}
+
+uint64_t Scene::loadMesh(const std::string& path) {
+    std::string key = GeometryCache::meshKey(path);
+    if (geometryCache->find(key)) {
+        std::lock_guard<std::mutex> lock(shapeMutex);
+        new Mesh(pendingShapes, path);
+        return 0;
+    }
+    auto it = meshRequests.find(key);
+    if (it != meshRequests.end() && assetLoader->isPending(it->second.id)) {
+        ++it->second.count;
+        return it->second.id;
+    }
+    // A cancelled or failed load is requested again
+    uint64_t id = assetLoader->requestMesh(path);
+    meshRequests[key] = {id, 1};
+    return id;
+}
+
+void Scene::addShapes(ShapeStore& newShapes) {
+    std::vector<std::string> keys;
+    std::vector<uint64_t> requested;
+    for (Shape* shape : newShapes.getViews()) {
+        if (shape->getType() != "Mesh") continue;
+        const std::string& path = static_cast<Mesh*>(shape)->getObjPath();
+        std::string key = GeometryCache::meshKey(path);
+        if (std::find(keys.begin(), keys.end(), key) != keys.end() || geometryCache->find(key)) continue;
+        keys.push_back(key);
+        auto pending = meshRequests.find(key);
+        if (pending != meshRequests.end() && assetLoader->isPending(pending->second.id)) continue; // Finished below
+        requested.push_back(assetLoader->requestMesh(path));
+    }
+
+    // Held until every shape has acquired its geometry
+    std::vector<AssetLoader::Loaded> batch = assetLoader->finish();
+    for (const AssetLoader::Loaded& loaded : batch) {
+        if (std::find(requested.begin(), requested.end(), loaded.id) == requested.end()) {
+            addLoadedMesh(loaded); // Added from the editor, finished early by this batch
+        }
+    }
+
+    // Finds the geometry uploaded above; a failed load is retried here
+    initShapes(newShapes, *geometryCache);
+    shapes.append(newShapes);
+}
+
+bool Scene::queueShape(const std::string& type) {
+    std::lock_guard<std::mutex> lock(shapeMutex);
+    return Shape::createShape(pendingShapes, type) != nullptr;
+}
+
+void Scene::removeShape(Shape* shape) {
+    if (selectedShape == shape) selectedShape = nullptr;
+    removedShapes.push_back(shape);
+}
+
+void Scene::removeSpotlight(Spotlight* light) {
+    if (selectedSpotlight == light) selectedSpotlight = nullptr;
+    removedSpotlights.push_back(light);
+}
+
+void Scene::removeGameCamera(GameCamera* cam) {
+    if (selectedGameCamera == cam) selectedGameCamera = nullptr;
+    removedGameCameras.push_back(cam);
+}
+
+void Scene::clear() {
+    removedShapes.insert(removedShapes.end(), getShapes().begin(), getShapes().end());
+    removedSpotlights.insert(removedSpotlights.end(), getSpotlights().begin(), getSpotlights().end());
+    removedGameCameras.insert(removedGameCameras.end(), getGameCameras().begin(), getGameCameras().end());
+    selectedShape = nullptr;
+    selectedSpotlight = nullptr;
+    selectedGameCamera = nullptr;
+}
+
+// Entities stay listed until here, so the selection may have moved onto one
+void Scene::applyRemovals() {
+    // Removing a shape removes its children with it
+    if (!removedShapes.empty()) shapes.addDescendants(removedShapes);
+    clearIfRemoved(selectedShape, removedShapes);
+    clearIfRemoved(selectedSpotlight, removedSpotlights);
+    clearIfRemoved(selectedGameCamera, removedGameCameras);
+    // Removal lists may name an entity twice (e.g. deleted, then reset); the stores ignore repeats
+    shapes.erase(removedShapes);
+    spotlights.erase(removedSpotlights);
+    gameCameras.erase(removedGameCameras);
+    removedShapes.clear();
+    removedSpotlights.clear();
+    removedGameCameras.clear();
+}
+
+void Scene::applyPendingShapes() {
+    std::lock_guard<std::mutex> lock(shapeMutex);
+    initShapes(pendingShapes, *geometryCache);
+    shapes.append(pendingShapes);
+}
+
+void Scene::applyLoadedMeshes() {
+    for (const AssetLoader::Loaded& loaded : assetLoader->update(UPLOAD_BYTES_PER_FRAME, UPLOAD_MS_PER_FRAME)) {
+        addLoadedMesh(loaded);
+    }
+}
+
+void Scene::addLoadedMesh(const AssetLoader::Loaded& loaded) {
+    int count = 1;
+    auto it = meshRequests.find(GeometryCache::meshKey(loaded.path));
+    if (it != meshRequests.end() && it->second.id == loaded.id) {
+        count = it->second.count;
+        meshRequests.erase(it);
+    }
+    for (int i = 0; i < count; ++i) {
+        Mesh* mesh = new Mesh(shapes, loaded.path);
+        try {
+            mesh->init(*geometryCache); // Finds the geometry just uploaded
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to initialize shape: " << e.what() << std::endl;
+            shapes.erase({mesh});
+        }
+    }
+}
+
+// Recomputes moved shapes and writes every changed one into its instance slot
+void Scene::updateInstances() {
+    uint32_t count = shapes.size();
+    instances->resize(count);
+    slotOwners.resize(count, nullptr);
+
+    // Any light change invalidates every object's light list
+    bool lightsChanged = lightBuffer->update(spotlights);
+
+    shapes.updateTransforms();
+    const std::vector<Shape*>& views = shapes.getViews();
+    for (uint32_t i = 0; i < count; ++i) {
+        // Deleting a shape shifts the ones after it into new slots
+        if (shapes.instanceDirty[i] || slotOwners[i] != views[i] || lightsChanged) {
+            const Geometry* geometry = shapes.geometries[i].get();
+            glm::vec4 lights = geometry ? lightBuffer->selectLights(shapes.worldBounds[i]) : glm::vec4(-1.0f);
+            // Stored positions are quantized; the dequantization rides along in the instance matrix
+            glm::mat4 model = geometry ? shapes.modelMatrices[i] * geometry->dequantize : shapes.modelMatrices[i];
+            instances->write(i, {model, shapes.colors[i], lights});
+            shapes.instanceDirty[i] = false;
+            slotOwners[i] = views[i];
+        }
+    }
+    instances->upload();
+}
+
+void Scene::update() {
+    applyRemovals();
+    applyPendingShapes();
+    applyLoadedMeshes();
+    updateInstances();
+    ++frameNumber;
+}
+
+void Scene::buildSnapshot(SceneSnapshot& snapshot, bool fence) const {
+    snapshot.frame = frameNumber;
+    snapshot.instances = instances;
+    snapshot.items.clear();
+    snapshot.lines.clear();
+
+    for (uint32_t i = 0; i < shapes.size(); ++i) {
+        if (!shapes.geometries[i]) continue;
+        snapshot.items.push_back({shapes.geometries[i].get(), shapes.worldBounds[i], i, shapes.colors[i].a < 1.0f});
+    }
+    for (uint32_t i = 0; i < spotlights.size(); ++i) {
+        glm::vec3 start = spotlights.positions[i];
+        snapshot.lines.push_back({start, start + spotlights.directions[i] * 2.0f, glm::vec4(1.0f, 1.0f, 0.0f, 1.0f)}); // Yellow
+    }
+    if (selectedGameCamera) {
+        glm::vec3 start = selectedGameCamera->getPosition();
+        snapshot.lines.push_back({start, start + selectedGameCamera->getForward() * 2.0f, glm::vec4(0.0f, 1.0f, 1.0f, 1.0f)}); // Cyan
+    }
+
+    snapshot.uploaded = fence ? glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : nullptr;
+    // Other contexts only see these writes once this one has flushed them
+    glFlush();
+}
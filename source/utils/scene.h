@@ -0,0 +1,139 @@
+#pragma once
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include "shape.h"
+#include "mesh.h"
+#include "spotlight.h"
+#include "gamecamera.h"
+#include "geometry.h"
+#include "instancebuffer.h"
+#include "lightbuffer.h"
+#include "assetloader.h"
+
+// What a view needs to draw one frame, copied out of the Scene after its
+// update. Render threads read only this, never the Scene, so the main
+// thread is free to edit entities while they draw. Geometry pointers stay
+// valid until the next Scene::update, which runs only after every view
+// has finished with the frame.
+struct SceneSnapshot {
+    struct Item {
+        Geometry* geometry;
+        Bounds bounds;          // World space
+        uint32_t slot;          // Instance slot
+        bool transparent;
+    };
+    struct Line {
+        glm::vec3 start;
+        glm::vec3 end;
+        glm::vec4 color;
+    };
+
+    uint64_t frame;
+    std::vector<Item> items;
+    std::vector<Line> lines;    // Spotlight and selected game camera directions
+    const InstanceBuffer* instances;
+    GLsync uploaded;            // Signaled once the frame's uploads are done; null when drawn on the uploading thread
+};
+
+// The one set of entities every window renders, plus the selection the
+// editor panels act on. Renderers keep only a camera and view settings, so
+// an edit made through any window shows up in all of them.
+// Instance and light data are scene-wide GL objects (all contexts share one
+// namespace) and are synced once per frame by update(). Removals and shapes
+// built off-thread are applied there too, so every view of a frame sees the
+// same entity list. Meshes added from the editor load on the asset loader's
+// workers and join the scene once their upload completes.
+// Entities live in component stores; a shape's dense id is its instance
+// slot, and the per-frame passes run over the stores' arrays.
+class Scene {
+private:
+    // Per-frame upload budget for meshes finished by the asset loader
+    static const size_t UPLOAD_BYTES_PER_FRAME = 16 << 20;
+    static constexpr double UPLOAD_MS_PER_FRAME = 2.0;
+
+    ShapeStore shapes;
+    SpotlightStore spotlights;
+    GameCameraStore gameCameras;
+    Shape* selectedShape;
+    Spotlight* selectedSpotlight;
+    GameCamera* selectedGameCamera;
+    std::vector<Shape*> removedShapes;
+    std::vector<Spotlight*> removedSpotlights;
+    std::vector<GameCamera*> removedGameCameras;
+    std::mutex shapeMutex;
+    ShapeStore pendingShapes;       // Guarded by shapeMutex
+
+    // Editor loads in flight by mesh key, with the meshes each adds once uploaded
+    struct MeshRequest {
+        uint64_t id;
+        int count;
+    };
+
+    GeometryCache* geometryCache;
+    AssetLoader* assetLoader;
+    std::unordered_map<std::string, MeshRequest> meshRequests;
+    InstanceBuffer* instances;
+    LightBuffer* lightBuffer;
+    std::vector<Shape*> slotOwners; // Shape last written to each instance slot
+    uint64_t frameNumber;
+
+    void applyRemovals();
+    void applyPendingShapes();
+    void applyLoadedMeshes();
+    void addLoadedMesh(const AssetLoader::Loaded& loaded);
+    void updateInstances();
+
+public:
+    // Creates the scene's GL objects; a context of the share group must be current
+    Scene(GeometryCache& geometryCache);
+    ~Scene();
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
+    // Moves a loaded scene's shapes in one batch: every distinct mesh not yet
+    // cached is loaded on the asset loader's workers at once and uploaded
+    // before this returns. Shapes that fail to initialize are deleted.
+    void addShapes(ShapeStore& newShapes);
+    void addSpotlights(SpotlightStore& newSpotlights) { spotlights.append(newSpotlights); }
+    void addGameCameras(GameCameraStore& newGameCameras) { gameCameras.append(newGameCameras); }
+    // Applies queued edits and uploads changed instance and light data.
+    // Call once per frame, before any view renders.
+    void update();
+    // Fills snapshot from the state left by update(). With fence set, also
+    // fences the uploads so other contexts can wait on them.
+    void buildSnapshot(SceneSnapshot& snapshot, bool fence) const;
+
+    // Safe to call from any thread; the shape joins the scene on the next
+    // update. False when type is not a primitive.
+    bool queueShape(const std::string& type);
+    // Adds a mesh of the .obj, loading it in the background unless cached.
+    // Requests for a path already loading share its load. Returns the load's
+    // id, or 0 when the geometry was cached and the mesh joins on the next
+    // update. Main thread only.
+    uint64_t loadMesh(const std::string& path);
+    AssetLoader& getAssetLoader() { return *assetLoader; }
+    Spotlight* addSpotlight(const std::string& name) { return new Spotlight(spotlights, name); }
+    GameCamera* addGameCamera(const std::string& name) { return new GameCamera(gameCameras, name); }
+    void removeShape(Shape* shape);
+    void removeSpotlight(Spotlight* light);
+    void removeGameCamera(GameCamera* cam);
+    void clear();
+
+    // Views in dense id order, which is also instance slot order
+    const std::vector<Shape*>& getShapes() const { return shapes.getViews(); }
+    const std::vector<Spotlight*>& getSpotlights() const { return spotlights.getViews(); }
+    const std::vector<GameCamera*>& getGameCameras() const { return gameCameras.getViews(); }
+    const ShapeStore& getShapeStore() const { return shapes; }
+    const SpotlightStore& getSpotlightStore() const { return spotlights; }
+    const GameCameraStore& getGameCameraStore() const { return gameCameras; }
+    Shape* getSelectedShape() const { return selectedShape; }
+    void setSelectedShape(Shape* shape) { selectedShape = shape; }
+    Spotlight* getSelectedSpotlight() const { return selectedSpotlight; }
+    void setSelectedSpotlight(Spotlight* light) { selectedSpotlight = light; }
+    GameCamera* getSelectedGameCamera() const { return selectedGameCamera; }
+    void setSelectedGameCamera(GameCamera* cam) { selectedGameCamera = cam; }
+
+    const InstanceBuffer& getInstances() const { return *instances; }
+    const LightBuffer& getLights() const { return *lightBuffer; }
+};
@@ -0,0 +1,275 @@
+#include "scenefile.h"
+#include "shape.h"
+#include "mesh.h"
+#include "spotlight.h"
+#include "gamecamera.h"
+#include "mappedfile.h"
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+const char* const SceneFile::DEFAULT_PATH = "scene.oscene";
+
+namespace {
+
+const char MAGIC[4] = {'O', 'S', 'C', 'N'};
+
+enum BlockIndex {
+    WINDOWS,
+    SHAPE_POSITIONS, SHAPE_ROTATIONS, SHAPE_SCALES, SHAPE_COLORS, SHAPE_TYPES, SHAPE_MESHES,
+    SPOTLIGHT_POSITIONS, SPOTLIGHT_DIRECTIONS, SPOTLIGHT_COLORS, SPOTLIGHT_CUTOFFS, SPOTLIGHT_INTENSITIES, SPOTLIGHT_NAMES,
+    GAME_CAMERA_POSITIONS, GAME_CAMERA_ROTATIONS, GAME_CAMERA_FOVS, GAME_CAMERA_NAMES,
+    STRING_OFFSETS, STRING_DATA,
+    SHAPE_PARENTS,      // Version 2; blocks are only ever added at the end
+    BLOCK_COUNT
+};
+const int VERSION_1_BLOCK_COUNT = SHAPE_PARENTS;
+
+struct Block {
+    uint64_t offset;
+    uint64_t bytes;
+};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t windowCount;
+    uint32_t shapeCount;
+    uint32_t spotlightCount;
+    uint32_t gameCameraCount;
+    uint32_t stringCount;
+    uint32_t reserved;
+    Block blocks[BLOCK_COUNT];
+};
+static_assert(sizeof(Header) == 352, "Scene file header layout changed; bump VERSION");
+static_assert(sizeof(SceneWindowRecord) == 48, "Scene window record layout changed; bump VERSION");
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float) && sizeof(glm::vec4) == 4 * sizeof(float),
+              "Component arrays are written as packed floats");
+static_assert(ShapeStore::NO_ID == SceneBlocks::NO_PARENT, "Shape parents are written as they are");
+
+// Size every block must have for the header's counts; the string data is checked separately
+uint64_t expectedBytes(const Header& header, int block) {
+    const uint64_t vec3 = 3 * sizeof(float), vec4 = 4 * sizeof(float), scalar = sizeof(float), index = sizeof(uint32_t);
+    switch (block) {
+        case WINDOWS: return header.windowCount * (uint64_t)sizeof(SceneWindowRecord);
+        case SHAPE_POSITIONS: case SHAPE_ROTATIONS: case SHAPE_SCALES: return header.shapeCount * vec3;
+        case SHAPE_COLORS: return header.shapeCount * vec4;
+        case SHAPE_TYPES: case SHAPE_MESHES: case SHAPE_PARENTS: return header.shapeCount * index;
+        case SPOTLIGHT_POSITIONS: case SPOTLIGHT_DIRECTIONS: return header.spotlightCount * vec3;
+        case SPOTLIGHT_COLORS: return header.spotlightCount * vec4;
+        case SPOTLIGHT_CUTOFFS: case SPOTLIGHT_INTENSITIES: return header.spotlightCount * scalar;
+        case SPOTLIGHT_NAMES: return header.spotlightCount * index;
+        case GAME_CAMERA_POSITIONS: case GAME_CAMERA_ROTATIONS: return header.gameCameraCount * vec3;
+        case GAME_CAMERA_FOVS: return header.gameCameraCount * scalar;
+        case GAME_CAMERA_NAMES: return header.gameCameraCount * index;
+        case STRING_OFFSETS: return (header.stringCount + (uint64_t)1) * index;
+        default: return header.blocks[block].bytes;
+    }
+}
+
+bool validIndices(const uint32_t* indices, uint32_t count, uint32_t stringCount, bool optional) {
+    for (uint32_t i = 0; i < count; ++i) {
+        if (indices[i] >= stringCount && !(optional && indices[i] == SceneBlocks::NO_STRING)) return false;
+    }
+    return true;
+}
+
+// Builds the deduplicated string table while entities are written
+class StringTable {
+private:
+    std::unordered_map<std::string, uint32_t> indices;
+
+public:
+    std::vector<uint32_t> offsets{0};
+    std::string data;
+
+    uint32_t add(const std::string& text) {
+        auto it = indices.find(text);
+        if (it != indices.end()) return it->second;
+        uint32_t index = offsets.size() - 1;
+        indices.emplace(text, index);
+        data += text;
+        offsets.push_back(data.size());
+        return index;
+    }
+    uint32_t count() const { return offsets.size() - 1; }
+};
+
+// Copies the camera fields a window's settings hold into record
+void readCamera(const nlohmann::json& camera, SceneWindowRecord& record) {
+    auto vec3 = [&camera](const char* key, float* out) {
+        if (!camera.contains(key) || !camera[key].is_array() || camera[key].size() != 3) return false;
+        for (int i = 0; i < 3; ++i) {
+            if (!camera[key][i].is_number()) return false;
+            out[i] = camera[key][i].get<float>();
+        }
+        return true;
+    };
+    if (vec3("position", record.cameraPosition)) record.cameraFields |= SceneWindowRecord::CAMERA_POSITION;
+    if (vec3("rotation", record.cameraRotation)) record.cameraFields |= SceneWindowRecord::CAMERA_ROTATION;
+    if (camera.contains("fov") && camera["fov"].is_number_float()) {
+        record.cameraFov = camera["fov"].get<float>();
+        record.cameraFields |= SceneWindowRecord::CAMERA_FOV;
+    }
+}
+
+} // namespace
+
+bool SceneFile::matches(const unsigned char* data, size_t size) {
+    return size >= sizeof(MAGIC) && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+void SceneFile::read(const unsigned char* data, size_t size, SceneBlocks& blocks) {
+    Header header = {};
+    if (size < offsetof(Header, blocks) || !matches(data, size)) {
+        throw std::runtime_error("Invalid scene file: truncated header");
+    }
+    std::memcpy(&header, data, offsetof(Header, blocks));
+    if (header.version != VERSION && header.version != 1) {
+        throw std::runtime_error("Unsupported scene file version " + std::to_string(header.version) +
+                                 " (expected " + std::to_string(VERSION) + ")");
+    }
+    // Older headers hold a prefix of the blocks; the rest stay empty
+    int blockCount = header.version == 1 ? VERSION_1_BLOCK_COUNT : BLOCK_COUNT;
+    size_t headerBytes = offsetof(Header, blocks) + blockCount * sizeof(Block);
+    if (size < headerBytes) {
+        throw std::runtime_error("Invalid scene file: truncated header");
+    }
+    std::memcpy(&header, data, headerBytes);
+    for (int block = 0; block < blockCount; ++block) {
+        const Block& range = header.blocks[block];
+        if (range.bytes != expectedBytes(header, block) || range.offset % 16 != 0 ||
+            range.offset > size || range.bytes > size - range.offset) {
+            throw std::runtime_error("Invalid scene file: block " + std::to_string(block) + " out of range");
+        }
+    }
+
+    auto at = [&](int block) { return data + header.blocks[block].offset; };
+    blocks.windowCount = header.windowCount;
+    blocks.shapeCount = header.shapeCount;
+    blocks.spotlightCount = header.spotlightCount;
+    blocks.gameCameraCount = header.gameCameraCount;
+    blocks.stringCount = header.stringCount;
+    blocks.windows = reinterpret_cast<const SceneWindowRecord*>(at(WINDOWS));
+    blocks.shapePositions = reinterpret_cast<const float*>(at(SHAPE_POSITIONS));
+    blocks.shapeRotations = reinterpret_cast<const float*>(at(SHAPE_ROTATIONS));
+    blocks.shapeScales = reinterpret_cast<const float*>(at(SHAPE_SCALES));
+    blocks.shapeColors = reinterpret_cast<const float*>(at(SHAPE_COLORS));
+    blocks.shapeTypes = reinterpret_cast<const uint32_t*>(at(SHAPE_TYPES));
+    blocks.shapeMeshes = reinterpret_cast<const uint32_t*>(at(SHAPE_MESHES));
+    blocks.shapeParents = blockCount > SHAPE_PARENTS ? reinterpret_cast<const uint32_t*>(at(SHAPE_PARENTS)) : nullptr;
+    blocks.spotlightPositions = reinterpret_cast<const float*>(at(SPOTLIGHT_POSITIONS));
+    blocks.spotlightDirections = reinterpret_cast<const float*>(at(SPOTLIGHT_DIRECTIONS));
+    blocks.spotlightColors = reinterpret_cast<const float*>(at(SPOTLIGHT_COLORS));
+    blocks.spotlightCutoffs = reinterpret_cast<const float*>(at(SPOTLIGHT_CUTOFFS));
+    blocks.spotlightIntensities = reinterpret_cast<const float*>(at(SPOTLIGHT_INTENSITIES));
+    blocks.spotlightNames = reinterpret_cast<const uint32_t*>(at(SPOTLIGHT_NAMES));
+    blocks.gameCameraPositions = reinterpret_cast<const float*>(at(GAME_CAMERA_POSITIONS));
+    blocks.gameCameraRotations = reinterpret_cast<const float*>(at(GAME_CAMERA_ROTATIONS));
+    blocks.gameCameraFovs = reinterpret_cast<const float*>(at(GAME_CAMERA_FOVS));
+    blocks.gameCameraNames = reinterpret_cast<const uint32_t*>(at(GAME_CAMERA_NAMES));
+    blocks.stringOffsets = reinterpret_cast<const uint32_t*>(at(STRING_OFFSETS));
+    blocks.stringData = reinterpret_cast<const char*>(at(STRING_DATA));
+
+    // Every string index is checked once here, so readers can use them unchecked
+    bool valid = blocks.stringOffsets[0] == 0
+        && blocks.stringOffsets[header.stringCount] == header.blocks[STRING_DATA].bytes;
+    for (uint32_t i = 0; valid && i < header.stringCount; ++i) {
+        valid = blocks.stringOffsets[i] <= blocks.stringOffsets[i + 1];
+    }
+    for (uint32_t i = 0; valid && i < header.windowCount; ++i) {
+        const SceneWindowRecord& window = blocks.windows[i];
+        valid = window.type < header.stringCount && (window.title < header.stringCount || window.title == SceneBlocks::NO_STRING);
+    }
+    valid = valid
+        && validIndices(blocks.shapeTypes, header.shapeCount, header.stringCount, false)
+        && validIndices(blocks.shapeMeshes, header.shapeCount, header.stringCount, true)
+        && validIndices(blocks.spotlightNames, header.spotlightCount, header.stringCount, false)
+        && validIndices(blocks.gameCameraNames, header.gameCameraCount, header.stringCount, false);
+    if (!valid) {
+        throw std::runtime_error("Invalid scene file: bad string table");
+    }
+    for (uint32_t i = 0; blocks.shapeParents && i < header.shapeCount; ++i) {
+        uint32_t parent = blocks.shapeParents[i];
+        if (parent >= header.shapeCount && parent != SceneBlocks::NO_PARENT) {
+            throw std::runtime_error("Invalid scene file: bad shape parent");
+        }
+    }
+}
+
+bool SceneFile::write(const std::string& path, const std::vector<nlohmann::json>& windows, const ShapeStore& shapes,
+                      const SpotlightStore& spotlights, const GameCameraStore& gameCameras) {
+    StringTable strings;
+
+    std::vector<SceneWindowRecord> windowRecords;
+    for (const nlohmann::json& window : windows) {
+        SceneWindowRecord record = {};
+        record.type = strings.add(window.contains("type") && window["type"].is_string()
+            ? window["type"].get<std::string>() : "WINDOW_MAIN");
+        record.title = window.contains("title") && window["title"].is_string()
+            ? strings.add(window["title"].get<std::string>()) : SceneBlocks::NO_STRING;
+        if (window.contains("width") && window["width"].is_number_unsigned() &&
+            window.contains("height") && window["height"].is_number_unsigned()) {
+            record.width = window["width"].get<uint32_t>();
+            record.height = window["height"].get<uint32_t>();
+        }
+        if (window.contains("camera") && window["camera"].is_object()) {
+            readCamera(window["camera"], record);
+        }
+        windowRecords.push_back(record);
+    }
+
+    // Component arrays are written as they are; only the string references are built here
+    std::vector<uint32_t> shapeTypes, shapeMeshes;
+    for (const Shape* shape : shapes.getViews()) {
+        shapeTypes.push_back(strings.add(shape->getType()));
+        shapeMeshes.push_back(shape->getType() == "Mesh"
+            ? strings.add(static_cast<const Mesh*>(shape)->getObjPath()) : SceneBlocks::NO_STRING);
+    }
+    std::vector<uint32_t> spotlightNames;
+    for (const Spotlight* light : spotlights.getViews()) {
+        spotlightNames.push_back(strings.add(light->getName()));
+    }
+    std::vector<uint32_t> gameCameraNames;
+    for (const GameCamera* cam : gameCameras.getViews()) {
+        gameCameraNames.push_back(strings.add(cam->getName()));
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.windowCount = windowRecords.size();
+    header.shapeCount = shapes.size();
+    header.spotlightCount = spotlights.size();
+    header.gameCameraCount = gameCameras.size();
+    header.stringCount = strings.count();
+
+    const void* contents[BLOCK_COUNT] = {
+        windowRecords.data(),
+        shapes.positions.data(), shapes.rotations.data(), shapes.scales.data(), shapes.colors.data(),
+        shapeTypes.data(), shapeMeshes.data(),
+        spotlights.positions.data(), spotlights.directions.data(), spotlights.colors.data(), spotlights.cutoffs.data(),
+        spotlights.intensities.data(), spotlightNames.data(),
+        gameCameras.positions.data(), gameCameras.rotations.data(), gameCameras.fovs.data(), gameCameraNames.data(),
+        strings.offsets.data(), strings.data.data(),
+        shapes.parents.data()
+    };
+    header.blocks[STRING_DATA].bytes = strings.data.size();
+    uint64_t offset = MappedFileWriter::align(sizeof(header));
+    for (int block = 0; block < BLOCK_COUNT; ++block) {
+        header.blocks[block].offset = offset;
+        header.blocks[block].bytes = expectedBytes(header, block);
+        offset = MappedFileWriter::align(offset + header.blocks[block].bytes);
+    }
+
+    MappedFileWriter file("scene file");
+    if (!file.open(path)) {
+        return false;
+    }
+    file.write(&header, sizeof(header));
+    for (int block = 0; block < BLOCK_COUNT; ++block) {
+        file.padTo(header.blocks[block].offset);
+        file.write(contents[block], header.blocks[block].bytes);
+    }
+    return file.commit();
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "nlohmann/json.hpp"
+
+class ShapeStore;
+class SpotlightStore;
+class GameCameraStore;
+
+// One window's settings as stored in a scene file
+struct SceneWindowRecord {
+    enum CameraField { CAMERA_POSITION = 1, CAMERA_ROTATION = 2, CAMERA_FOV = 4 };
+
+    uint32_t type;              // String index of the type name, e.g. WINDOW_MAIN
+    uint32_t title;             // String index, NO_STRING when unset
+    uint32_t width, height;     // 0 when unset
+    uint32_t cameraFields;      // CameraField bits present
+    float cameraPosition[3];
+    float cameraRotation[3];
+    float cameraFov;
+};
+
+// The arrays of a scene file, pointing into its mapping
+struct SceneBlocks {
+    static const uint32_t NO_STRING = 0xffffffffu;
+    static const uint32_t NO_PARENT = 0xffffffffu;
+
+    uint32_t windowCount, shapeCount, spotlightCount, gameCameraCount, stringCount;
+    const SceneWindowRecord* windows;
+    const float* shapePositions;        // 3 per shape
+    const float* shapeRotations;        // 3 per shape
+    const float* shapeScales;           // 3 per shape
+    const float* shapeColors;           // 4 per shape
+    const uint32_t* shapeTypes;         // String index
+    const uint32_t* shapeMeshes;        // String index of the .obj path, NO_STRING for primitives
+    const uint32_t* shapeParents;       // Index of the parent shape, NO_PARENT for roots; null in version 1 files
+    const float* spotlightPositions;    // 3 per light
+    const float* spotlightDirections;   // 3 per light
+    const float* spotlightColors;       // 4 per light
+    const float* spotlightCutoffs;
+    const float* spotlightIntensities;
+    const uint32_t* spotlightNames;
+    const float* gameCameraPositions;   // 3 per camera
+    const float* gameCameraRotations;   // 3 per camera
+    const float* gameCameraFovs;
+    const uint32_t* gameCameraNames;
+    const uint32_t* stringOffsets;      // stringCount + 1 offsets into stringData
+    const char* stringData;
+
+    std::string string(uint32_t index) const {
+        return std::string(stringData + stringOffsets[index], stringOffsets[index + 1] - stringOffsets[index]);
+    }
+};
+
+// Binary scene snapshot (.oscene) holding what scene.json does, laid out to
+// be mapped and read without parsing. Layout: header, then one block per
+// array, each 16-byte aligned. Entities are stored as structure-of-arrays,
+// the component stores' own layout, so transforms and colors are copied
+// in and out whole; names, types, window titles
+// and mesh paths are indices into a deduplicated string table. Version 1
+// files, from before shapes had parents, are still read.
+class SceneFile {
+public:
+    static const uint32_t VERSION = 2;
+    static const char* const DEFAULT_PATH;
+
+    // True when data starts like a scene file, of any version
+    static bool matches(const unsigned char* data, size_t size);
+    // Points blocks into data, which must stay mapped while they are used.
+    // Throws std::runtime_error when the file is another version or malformed.
+    static void read(const unsigned char* data, size_t size, SceneBlocks& blocks);
+    // Windows are settings objects as Window::ToJSON writes them. Failures are reported and return false.
+    static bool write(const std::string& path, const std::vector<nlohmann::json>& windows, const ShapeStore& shapes,
+                      const SpotlightStore& spotlights, const GameCameraStore& gameCameras);
+};
@@ -0,0 +1,623 @@
+#include "sceneloader.h"
+#include "scene.h"
+#include "mappedfile.h"
+#include "scenefile.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+enum class EntityKind { Shape, Spotlight, GameCamera };
+
+enum VectorField { POSITION, SCALE, ROTATION, DIRECTION, COLOR, VECTOR_FIELDS };
+enum ScalarField { CUTOFF, INTENSITY, FOV, SCALAR_FIELDS };
+enum StringField { TYPE, NAME, OBJ_PATH, STRING_FIELDS };
+
+// One entity's fields as read, before it is constructed
+struct EntityRecord {
+    float vectors[VECTOR_FIELDS][4];
+    int vectorSizes[VECTOR_FIELDS];     // -1 when absent or not all numbers
+    float scalars[SCALAR_FIELDS];
+    bool hasScalar[SCALAR_FIELDS];
+    std::string strings[STRING_FIELDS];
+    bool hasString[STRING_FIELDS];
+    int64_t parent;                     // Index of the parent shape in the same list, -1 for none
+
+    void reset() {
+        parent = -1;
+        std::fill(std::begin(vectorSizes), std::end(vectorSizes), -1);
+        std::fill(std::begin(hasScalar), std::end(hasScalar), false);
+        std::fill(std::begin(hasString), std::end(hasString), false);
+    }
+    bool vec3(VectorField field, glm::vec3& out) const {
+        if (vectorSizes[field] != 3) return false;
+        out = glm::vec3(vectors[field][0], vectors[field][1], vectors[field][2]);
+        return true;
+    }
+    bool vec4(VectorField field, glm::vec4& out) const {
+        if (vectorSizes[field] != 4) return false;
+        out = glm::vec4(vectors[field][0], vectors[field][1], vectors[field][2], vectors[field][3]);
+        return true;
+    }
+};
+
+// An entity list already built: its hash and the ids its entities got
+struct BuiltList {
+    EntityKind kind;
+    uint64_t hash;
+    uint32_t first;     // Id of its first entity in the kind's store
+    uint32_t count;
+};
+
+bool entityKind(const std::string& key, EntityKind& kind) {
+    if (key == "shapes") kind = EntityKind::Shape;
+    else if (key == "spotlights") kind = EntityKind::Spotlight;
+    else if (key == "gameCameras") kind = EntityKind::GameCamera;
+    else return false;
+    return true;
+}
+
+int vectorField(const std::string& key) {
+    if (key == "position") return POSITION;
+    if (key == "scale") return SCALE;
+    if (key == "rotation") return ROTATION;
+    if (key == "direction") return DIRECTION;
+    if (key == "color") return COLOR;
+    return -1;
+}
+
+int scalarField(const std::string& key) {
+    if (key == "cutoff") return CUTOFF;
+    if (key == "intensity") return INTENSITY;
+    if (key == "fov") return FOV;
+    return -1;
+}
+
+int stringField(const std::string& key) {
+    if (key == "type") return TYPE;
+    if (key == "name") return NAME;
+    if (key == "objPath") return OBJ_PATH;
+    return -1;
+}
+
+class SceneHandler : public nlohmann::json_sax<nlohmann::json> {
+private:
+    enum class Context { Document, Windows, Window, EntityList, Entity, Vector, Capture, Skip };
+
+    std::vector<Context> stack;
+    std::string currentKey;
+
+    // Window settings are rebuilt as JSON; captures point into the window being read
+    nlohmann::json window;
+    std::vector<nlohmann::json*> captures;
+
+    // The entity list being read; each entity is built as its object closes,
+    // so only its id is kept, for parents given by index
+    EntityKind kind;
+    EntityRecord record;
+    uint32_t listFirst;
+    std::vector<uint32_t> listIds;      // Per record, NO_ID when skipped
+    std::vector<std::pair<uint32_t, uint32_t>> parentLinks; // Shape id and its parent's record
+    int vector;
+    int vectorSize;
+    uint64_t listHash;
+    std::vector<BuiltList> builtLists;
+
+    std::vector<nlohmann::json>& windows;
+    ShapeStore& shapes;
+    SpotlightStore& spotlights;
+    GameCameraStore& gameCameras;
+
+    Context top() const { return stack.back(); }
+    bool inList() const { return std::find(stack.begin(), stack.end(), Context::EntityList) != stack.end(); }
+
+    // FNV-1a over every event of the current list, to recognise repeated lists
+    void hash(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            listHash = (listHash ^ bytes[i]) * 1099511628211ull;
+        }
+    }
+    void hashEvent(char tag, const void* data = nullptr, size_t size = 0) {
+        if (!inList()) return;
+        hash(&tag, 1);
+        hash(data, size);
+    }
+
+    void capture(nlohmann::json value) {
+        nlohmann::json* parent = captures.back();
+        if (parent->is_object()) (*parent)[currentKey] = std::move(value);
+        else parent->push_back(std::move(value));
+    }
+
+    void captureContainer(nlohmann::json value) {
+        nlohmann::json* parent = captures.back();
+        if (parent->is_object()) {
+            captures.push_back(&((*parent)[currentKey] = std::move(value)));
+        } else {
+            parent->push_back(std::move(value));
+            captures.push_back(&parent->back());
+        }
+    }
+
+    // A container opens; decides what reads its contents
+    void open(bool object) {
+        EntityKind listKind;
+        if (stack.empty()) {
+            stack.push_back(object ? Context::Document : Context::Skip);
+            return;
+        }
+        switch (top()) {
+            case Context::Document:
+                if (!object && currentKey == "windows") {
+                    stack.push_back(Context::Windows);
+                } else if (!object && entityKind(currentKey, listKind)) {
+                    beginList(listKind);
+                } else {
+                    stack.push_back(Context::Skip);
+                }
+                break;
+            case Context::Windows:
+                if (object) {
+                    window = nlohmann::json::object();
+                    captures.assign(1, &window);
+                    stack.push_back(Context::Window);
+                } else {
+                    stack.push_back(Context::Skip);
+                }
+                break;
+            case Context::Window:
+                if (!object && entityKind(currentKey, listKind)) {
+                    beginList(listKind);
+                    break;
+                }
+                // Fall through: any other setting is kept
+            case Context::Capture:
+                captureContainer(object ? nlohmann::json::object() : nlohmann::json::array());
+                stack.push_back(Context::Capture);
+                break;
+            case Context::EntityList:
+                if (object) {
+                    record.reset();
+                    stack.push_back(Context::Entity);
+                } else {
+                    stack.push_back(Context::Skip);
+                }
+                break;
+            case Context::Entity:
+                vector = object ? -1 : vectorField(currentKey);
+                if (vector >= 0) {
+                    vectorSize = 0;
+                    stack.push_back(Context::Vector);
+                } else {
+                    stack.push_back(Context::Skip);
+                }
+                break;
+            case Context::Vector:
+                vectorSize = -1; // Nested containers make the whole vector invalid
+                stack.push_back(Context::Skip);
+                break;
+            case Context::Skip:
+                stack.push_back(Context::Skip);
+                break;
+        }
+    }
+
+    void close() {
+        Context closed = top();
+        stack.pop_back();
+        switch (closed) {
+            case Context::Window:
+                windows.push_back(std::move(window));
+                captures.clear();
+                break;
+            case Context::Capture:
+                captures.pop_back();
+                break;
+            case Context::Entity:
+                addEntity();
+                break;
+            case Context::Vector:
+                record.vectorSizes[vector] = vectorSize;
+                break;
+            case Context::EntityList:
+                endList();
+                break;
+            default:
+                break;
+        }
+    }
+
+    uint32_t storeSize() const {
+        if (kind == EntityKind::Shape) return shapes.size();
+        if (kind == EntityKind::Spotlight) return spotlights.size();
+        return gameCameras.size();
+    }
+
+    void beginList(EntityKind listKind) {
+        kind = listKind;
+        listFirst = storeSize();
+        listIds.clear();
+        parentLinks.clear();
+        listHash = 14695981039346656037ull;
+        stack.push_back(Context::EntityList);
+        hash(&kind, sizeof(kind));
+    }
+
+    void addEntity() {
+        uint32_t id = build(record);
+        listIds.push_back(id);
+        if (kind == EntityKind::Shape && id != ShapeStore::NO_ID && record.parent >= 0 && record.parent <= UINT32_MAX) {
+            parentLinks.push_back({id, (uint32_t)record.parent});
+        }
+    }
+
+    // Parents may come later in the list, so they are linked once it ends,
+    // in record order like snapshots are
+    void endList() {
+        for (const auto& link : parentLinks) {
+            if (link.second < listIds.size() && listIds[link.second] != ShapeStore::NO_ID) {
+                shapes.setParent(link.first, listIds[link.second]);
+            }
+        }
+        listIds.clear();
+        parentLinks.clear();
+
+        // The hash only filters; a list is a repeat when the entities built
+        // from it match those of the earlier list too, and is erased again
+        uint32_t count = storeSize() - listFirst;
+        for (const BuiltList& built : builtLists) {
+            if (built.kind != kind || built.hash != listHash || built.count != count) continue;
+            if (sameEntities(built.first, listFirst, count)) {
+                eraseFrom(listFirst);
+                return;
+            }
+        }
+        builtLists.push_back({kind, listHash, listFirst, count});
+    }
+
+    // Compares the entities from ids a and b on, count of each, in the current kind's store
+    bool sameEntities(uint32_t a, uint32_t b, uint32_t count) const {
+        for (uint32_t i = 0; i < count; ++i, ++a, ++b) {
+            if (kind == EntityKind::Shape) {
+                const Shape* x = shapes.getViews()[a];
+                const Shape* y = shapes.getViews()[b];
+                if (x->getType() != y->getType()) return false;
+                if (x->getType() == "Mesh" &&
+                    static_cast<const Mesh*>(x)->getObjPath() != static_cast<const Mesh*>(y)->getObjPath()) return false;
+                if (shapes.positions[a] != shapes.positions[b] || shapes.scales[a] != shapes.scales[b] ||
+                    shapes.rotations[a] != shapes.rotations[b] || shapes.colors[a] != shapes.colors[b]) return false;
+                // Parents lie in the same list, so compare them relative to its start
+                uint32_t px = shapes.parents[a], py = shapes.parents[b];
+                if ((px == ShapeStore::NO_ID) != (py == ShapeStore::NO_ID)) return false;
+                if (px != ShapeStore::NO_ID && px - (a - i) != py - (b - i)) return false;
+            } else if (kind == EntityKind::Spotlight) {
+                if (spotlights.getViews()[a]->getName() != spotlights.getViews()[b]->getName()) return false;
+                if (spotlights.positions[a] != spotlights.positions[b] ||
+                    spotlights.directions[a] != spotlights.directions[b] ||
+                    spotlights.colors[a] != spotlights.colors[b] || spotlights.cutoffs[a] != spotlights.cutoffs[b] ||
+                    spotlights.intensities[a] != spotlights.intensities[b]) return false;
+            } else {
+                if (gameCameras.getViews()[a]->getName() != gameCameras.getViews()[b]->getName()) return false;
+                if (gameCameras.positions[a] != gameCameras.positions[b] ||
+                    gameCameras.rotations[a] != gameCameras.rotations[b] ||
+                    gameCameras.fovs[a] != gameCameras.fovs[b]) return false;
+            }
+        }
+        return true;
+    }
+
+    // Erases the current kind's entities from first on; earlier ids are unchanged
+    template<typename Store>
+    static void eraseTail(Store& store, uint32_t first) {
+        const auto& views = store.getViews();
+        store.erase({views.begin() + first, views.end()});
+    }
+    void eraseFrom(uint32_t first) {
+        if (kind == EntityKind::Shape) eraseTail(shapes, first);
+        else if (kind == EntityKind::Spotlight) eraseTail(spotlights, first);
+        else eraseTail(gameCameras, first);
+    }
+
+    // Returns the new entity's id in its kind's store, or NO_ID when skipped
+    uint32_t build(const EntityRecord& entity) {
+        glm::vec3 v3;
+        glm::vec4 v4;
+        if (kind == EntityKind::Shape) {
+            if (!entity.hasString[TYPE]) return ShapeStore::NO_ID;
+            Shape* shape = entity.strings[TYPE] == "Mesh" && entity.hasString[OBJ_PATH]
+                ? new Mesh(shapes, entity.strings[OBJ_PATH]) : Shape::createShape(shapes, entity.strings[TYPE]);
+            if (!shape) return ShapeStore::NO_ID;
+            if (entity.vec3(POSITION, v3)) shape->setPosition(v3);
+            if (entity.vec3(SCALE, v3)) shape->setScale(v3);
+            if (entity.vec3(ROTATION, v3)) shape->setRotation(v3);
+            if (entity.vec4(COLOR, v4)) shape->setColor(v4);
+            return shape->getId();
+        } else if (kind == EntityKind::Spotlight) {
+            if (!entity.hasString[NAME]) return ShapeStore::NO_ID;
+            Spotlight* light = new Spotlight(spotlights, entity.strings[NAME]);
+            if (entity.vec3(POSITION, v3)) light->setPosition(v3);
+            if (entity.vec3(DIRECTION, v3)) light->setDirection(v3);
+            if (entity.vec4(COLOR, v4)) light->setColor(v4);
+            if (entity.hasScalar[CUTOFF]) light->setCutoff(entity.scalars[CUTOFF]);
+            if (entity.hasScalar[INTENSITY]) light->setIntensity(entity.scalars[INTENSITY]);
+            return light->getId();
+        } else {
+            if (!entity.hasString[NAME]) return ShapeStore::NO_ID;
+            GameCamera* cam = new GameCamera(gameCameras, entity.strings[NAME]);
+            if (entity.vec3(POSITION, v3)) cam->setPosition(v3);
+            if (entity.vec3(ROTATION, v3)) cam->setRotation(v3);
+            if (entity.hasScalar[FOV]) cam->setFov(entity.scalars[FOV]);
+            return cam->getId();
+        }
+    }
+
+    // Scalars: integers count as numbers only inside vectors, like the DOM loader's is_number_float checks
+    bool number(double value, bool isFloat, const nlohmann::json& json) {
+        switch (top()) {
+            case Context::Window:
+            case Context::Capture:
+                capture(json);
+                break;
+            case Context::Entity: {
+                int field = scalarField(currentKey);
+                if (field >= 0 && isFloat) {
+                    record.scalars[field] = (float)value;
+                    record.hasScalar[field] = true;
+                } else if (currentKey == "parent" && !isFloat && value >= 0) {
+                    record.parent = (int64_t)value;
+                }
+                break;
+            }
+            case Context::Vector:
+                if (vectorSize >= 0 && vectorSize < 4) record.vectors[vector][vectorSize] = (float)value;
+                if (vectorSize >= 0) ++vectorSize;
+                break;
+            default:
+                break;
+        }
+        return true;
+    }
+
+    bool other(const nlohmann::json& json) {
+        if (top() == Context::Window || top() == Context::Capture) capture(json);
+        else if (top() == Context::Vector) vectorSize = -1;
+        return true;
+    }
+
+public:
+    SceneHandler(std::vector<nlohmann::json>& windows, ShapeStore& shapes,
+                 SpotlightStore& spotlights, GameCameraStore& gameCameras)
+        : kind(EntityKind::Shape), listFirst(0), vector(-1), vectorSize(0), listHash(0),
+          windows(windows), shapes(shapes), spotlights(spotlights), gameCameras(gameCameras) {}
+
+    bool null() override {
+        hashEvent('n');
+        return other(nullptr);
+    }
+    bool boolean(bool value) override {
+        hashEvent('b', &value, sizeof(value));
+        return other(value);
+    }
+    bool number_integer(number_integer_t value) override {
+        hashEvent('i', &value, sizeof(value));
+        return number((double)value, false, value);
+    }
+    bool number_unsigned(number_unsigned_t value) override {
+        hashEvent('u', &value, sizeof(value));
+        return number((double)value, false, value);
+    }
+    bool number_float(number_float_t value, const string_t&) override {
+        hashEvent('f', &value, sizeof(value));
+        return number(value, true, value);
+    }
+    bool string(string_t& value) override {
+        hashEvent('s', value.data(), value.size() + 1);
+        if (top() == Context::Entity) {
+            int field = stringField(currentKey);
+            if (field >= 0) {
+                record.strings[field] = value;
+                record.hasString[field] = true;
+            }
+            return true;
+        }
+        return other(value);
+    }
+    bool binary(binary_t&) override {
+        return other(nullptr);
+    }
+    bool start_object(std::size_t) override {
+        hashEvent('{');
+        open(true);
+        return true;
+    }
+    bool key(string_t& value) override {
+        hashEvent('k', value.data(), value.size() + 1);
+        currentKey = value;
+        return true;
+    }
+    bool end_object() override {
+        close();
+        hashEvent('}');
+        return true;
+    }
+    bool start_array(std::size_t) override {
+        hashEvent('[');
+        open(false);
+        return true;
+    }
+    bool end_array() override {
+        close();
+        hashEvent(']');
+        return true;
+    }
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& error) override {
+        throw std::runtime_error("Invalid scene JSON at byte " + std::to_string(position) + ": " + error.what());
+    }
+};
+
+// Copies the file's rows listed in sources into column, starting at first.
+// A component is one or more floats, so the mapped rows are copied as is.
+template<typename T>
+void copyRows(std::vector<T>& column, uint32_t first, const float* values, const std::vector<uint32_t>& sources) {
+    static_assert(sizeof(T) % sizeof(float) == 0, "Components must be whole floats");
+    const T* rows = reinterpret_cast<const T*>(values);
+    if (sources.empty()) return;
+    // sources is increasing, so it names every row when its last entry is its last index
+    if (sources.back() == sources.size() - 1) {
+        std::memcpy(column.data() + first, rows, sources.size() * sizeof(T));
+        return;
+    }
+    for (size_t i = 0; i < sources.size(); ++i) {
+        column[first + i] = rows[sources[i]];
+    }
+}
+
+} // namespace
+
+bool SceneLoader::loadFile(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    if (SceneFile::matches(file.data(), file.size())) {
+        loadBinary(file.data(), file.size());
+        return true;
+    }
+    SceneHandler handler(windows, shapes, spotlights, gameCameras);
+    const char* text = reinterpret_cast<const char*>(file.data());
+    nlohmann::json::sax_parse(text, text + file.size(), &handler);
+    return true;
+}
+
+void SceneLoader::loadString(const std::string& text) {
+    SceneHandler handler(windows, shapes, spotlights, gameCameras);
+    nlohmann::json::sax_parse(text, &handler);
+}
+
+// Transforms and colors are read in place from the mapping
+void SceneLoader::loadBinary(const unsigned char* data, size_t size) {
+    SceneBlocks blocks;
+    SceneFile::read(data, size, blocks);
+
+    for (uint32_t i = 0; i < blocks.windowCount; ++i) {
+        const SceneWindowRecord& record = blocks.windows[i];
+        nlohmann::json window = {{"type", blocks.string(record.type)}};
+        if (record.title != SceneBlocks::NO_STRING) window["title"] = blocks.string(record.title);
+        if (record.width > 0 && record.height > 0) {
+            window["width"] = record.width;
+            window["height"] = record.height;
+        }
+        if (record.cameraFields) {
+            nlohmann::json camera = nlohmann::json::object();
+            const float* p = record.cameraPosition;
+            const float* r = record.cameraRotation;
+            if (record.cameraFields & SceneWindowRecord::CAMERA_POSITION) camera["position"] = {p[0], p[1], p[2]};
+            if (record.cameraFields & SceneWindowRecord::CAMERA_ROTATION) camera["rotation"] = {r[0], r[1], r[2]};
+            if (record.cameraFields & SceneWindowRecord::CAMERA_FOV) camera["fov"] = record.cameraFov;
+            window["camera"] = camera;
+        }
+        windows.push_back(std::move(window));
+    }
+
+    // Views are created first; their components are then copied block by block
+    std::vector<uint32_t> sources;  // Record of each shape created, as unknown types are skipped
+    std::vector<uint32_t> ids(blocks.shapeCount, ShapeStore::NO_ID);
+    uint32_t first = shapes.size();
+    shapes.reserve(first + blocks.shapeCount);
+    for (uint32_t i = 0; i < blocks.shapeCount; ++i) {
+        std::string type = blocks.string(blocks.shapeTypes[i]);
+        Shape* shape = type == "Mesh" && blocks.shapeMeshes[i] != SceneBlocks::NO_STRING
+            ? new Mesh(shapes, blocks.string(blocks.shapeMeshes[i])) : Shape::createShape(shapes, type);
+        if (!shape) continue;
+        sources.push_back(i);
+        ids[i] = shape->getId();
+    }
+    copyRows(shapes.positions, first, blocks.shapePositions, sources);
+    copyRows(shapes.rotations, first, blocks.shapeRotations, sources);
+    copyRows(shapes.scales, first, blocks.shapeScales, sources);
+    copyRows(shapes.colors, first, blocks.shapeColors, sources);
+    // Parents are record indices; version 1 files have none
+    if (blocks.shapeParents) {
+        for (uint32_t i = 0; i < blocks.shapeCount; ++i) {
+            uint32_t parent = blocks.shapeParents[i];
+            if (ids[i] != ShapeStore::NO_ID && parent != SceneBlocks::NO_PARENT && ids[parent] != ShapeStore::NO_ID) {
+                shapes.setParent(ids[i], ids[parent]);
+            }
+        }
+    }
+
+    sources.clear();
+    first = spotlights.size();
+    spotlights.reserve(first + blocks.spotlightCount);
+    for (uint32_t i = 0; i < blocks.spotlightCount; ++i) {
+        new Spotlight(spotlights, blocks.string(blocks.spotlightNames[i]));
+        sources.push_back(i);
+    }
+    copyRows(spotlights.positions, first, blocks.spotlightPositions, sources);
+    copyRows(spotlights.directions, first, blocks.spotlightDirections, sources);
+    copyRows(spotlights.colors, first, blocks.spotlightColors, sources);
+    copyRows(spotlights.cutoffs, first, blocks.spotlightCutoffs, sources);
+    copyRows(spotlights.intensities, first, blocks.spotlightIntensities, sources);
+
+    sources.clear();
+    first = gameCameras.size();
+    gameCameras.reserve(first + blocks.gameCameraCount);
+    for (uint32_t i = 0; i < blocks.gameCameraCount; ++i) {
+        new GameCamera(gameCameras, blocks.string(blocks.gameCameraNames[i]));
+        sources.push_back(i);
+    }
+    copyRows(gameCameras.positions, first, blocks.gameCameraPositions, sources);
+    copyRows(gameCameras.rotations, first, blocks.gameCameraRotations, sources);
+    copyRows(gameCameras.fovs, first, blocks.gameCameraFovs, sources);
+}
+
+nlohmann::json SceneLoader::toJSON(const std::vector<nlohmann::json>& windows, const ShapeStore& shapes,
+                                   const SpotlightStore& spotlights, const GameCameraStore& gameCameras) {
+    auto vec3 = [](const glm::vec3& v) { return nlohmann::json{v.x, v.y, v.z}; };
+    auto vec4 = [](const glm::vec4& v) { return nlohmann::json{v.x, v.y, v.z, v.w}; };
+
+    nlohmann::json json = {{"windows", windows}};
+    nlohmann::json& shapesJson = json["shapes"] = nlohmann::json::array();
+    for (uint32_t i = 0; i < shapes.size(); ++i) {
+        const Shape* shape = shapes.getViews()[i];
+        nlohmann::json shapeJson = {
+            {"type", shape->getType()},
+            {"position", vec3(shapes.positions[i])},
+            {"rotation", vec3(shapes.rotations[i])},
+            {"scale", vec3(shapes.scales[i])},
+            {"color", vec4(shapes.colors[i])}
+        };
+        if (shape->getType() == "Mesh") shapeJson["objPath"] = static_cast<const Mesh*>(shape)->getObjPath();
+        if (shapes.parents[i] != ShapeStore::NO_ID) shapeJson["parent"] = shapes.parents[i];
+        shapesJson.push_back(std::move(shapeJson));
+    }
+    nlohmann::json& spotlightsJson = json["spotlights"] = nlohmann::json::array();
+    for (uint32_t i = 0; i < spotlights.size(); ++i) {
+        spotlightsJson.push_back({
+            {"name", spotlights.getViews()[i]->getName()},
+            {"position", vec3(spotlights.positions[i])},
+            {"direction", vec3(spotlights.directions[i])},
+            {"color", vec4(spotlights.colors[i])},
+            {"cutoff", spotlights.cutoffs[i]},
+            {"intensity", spotlights.intensities[i]}
+        });
+    }
+    nlohmann::json& gameCamerasJson = json["gameCameras"] = nlohmann::json::array();
+    for (uint32_t i = 0; i < gameCameras.size(); ++i) {
+        gameCamerasJson.push_back({
+            {"name", gameCameras.getViews()[i]->getName()},
+            {"position", vec3(gameCameras.positions[i])},
+            {"rotation", vec3(gameCameras.rotations[i])},
+            {"fov", gameCameras.fovs[i]}
+        });
+    }
+    return json;
+}
+
+void SceneLoader::addTo(Scene& scene) {
+    scene.addSpotlights(spotlights);
+    scene.addGameCameras(gameCameras);
+    scene.addShapes(shapes);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "shape.h"
+#include "spotlight.h"
+#include "gamecamera.h"
+
+class Scene;
+
+// Reads scene files: binary snapshots (see SceneFile) straight from their
+// mapping, and scene.json through nlohmann's SAX interface instead of a DOM.
+// Entity lists ("shapes", "spotlights", "gameCameras", at the top level or
+// inside a window) are decoded field by field into one fixed-size record,
+// and each entity is constructed as soon as its object ends. Older files
+// repeat the same lists in every window; a list whose entities turn out
+// identical to an earlier list's is erased again. Only the small
+// per-window settings are kept as JSON.
+// Nothing here touches GL, so a file can be read before any window exists.
+class SceneLoader {
+private:
+    std::vector<nlohmann::json> windows;
+    ShapeStore shapes;
+    SpotlightStore spotlights;
+    GameCameraStore gameCameras;
+
+    void loadBinary(const unsigned char* data, size_t size);
+
+public:
+    SceneLoader() {}
+    SceneLoader(const SceneLoader&) = delete;
+    SceneLoader& operator=(const SceneLoader&) = delete;
+
+    // Binary or JSON, told apart by content. False when the file cannot be
+    // opened; throws std::runtime_error when it is malformed.
+    bool loadFile(const std::string& path);
+    void loadString(const std::string& text);
+    // Serializes entities and window settings in the scene.json layout
+    static nlohmann::json toJSON(const std::vector<nlohmann::json>& windows, const ShapeStore& shapes,
+                                 const SpotlightStore& spotlights, const GameCameraStore& gameCameras);
+
+    // Each window's settings, without its entity lists
+    const std::vector<nlohmann::json>& getWindows() const { return windows; }
+    const ShapeStore& getShapes() const { return shapes; }
+    const SpotlightStore& getSpotlights() const { return spotlights; }
+    const GameCameraStore& getGameCameras() const { return gameCameras; }
+    size_t getEntityCount() const { return shapes.size() + spotlights.size() + gameCameras.size(); }
+    // Moves every entity into scene's stores; shape geometry is uploaded there in one batch
+    void addTo(Scene& scene);
+};
@@ -0,0 +1,222 @@
+#include "shaderprogram.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+const char* ShaderProgram::CACHE_DIRECTORY = "shader_cache";
+
+static const char BINARY_MAGIC[4] = {'S', 'W', 'P', '1'};
+
+struct BinaryHeader {
+    char magic[4];
+    GLenum format;
+    uint32_t length;
+    double compileMs; // Time the source build took, reported as saved on later hits
+};
+
+static ProgramCacheStats cacheStats = {};
+
+static GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        glDeleteShader(shader);
+        throw std::runtime_error("Shader compilation failed: " + std::string(infoLog));
+    }
+    return shader;
+}
+
+ShaderProgram::ShaderProgram(const char* vertexSource, const char* fragmentSource, const char* label) : id(0) {
+    std::string path = cachePath(vertexSource, fragmentSource);
+    auto start = std::chrono::steady_clock::now();
+    double recordedCompileMs = 0.0;
+    if (!path.empty() && loadBinary(path, recordedCompileMs)) {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        cacheStats.hits++;
+        cacheStats.loadMs += ms;
+        cacheStats.savedMs += recordedCompileMs - ms;
+    } else {
+        compileAndLink(vertexSource, fragmentSource, label, !path.empty());
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        cacheStats.misses++;
+        cacheStats.compileMs += ms;
+        if (!path.empty()) saveBinary(path, ms);
+    }
+
+    reflect();
+}
+
+void ShaderProgram::compileAndLink(const char* vertexSource, const char* fragmentSource, const char* label,
+                                   bool retrievable) {
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragmentShader;
+    try {
+        fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    } catch (...) {
+        glDeleteShader(vertexShader);
+        throw;
+    }
+
+    id = glCreateProgram();
+    if (retrievable) {
+        glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glAttachShader(id, vertexShader);
+    glAttachShader(id, fragmentShader);
+    glLinkProgram(id);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint success;
+    glGetProgramiv(id, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetProgramInfoLog(id, 512, nullptr, infoLog);
+        glDeleteProgram(id);
+        id = 0;
+        throw std::runtime_error(std::string(label) + " program linking failed: " + std::string(infoLog));
+    }
+}
+
+// Any driver update changes the strings and therefore the key, so stale
+// binaries are simply never looked up again. Empty when the context has no
+// program binaries: they need GL 4.1 or ARB_get_program_binary.
+std::string ShaderProgram::cachePath(const char* vertexSource, const char* fragmentSource) {
+    if (!glad_glProgramParameteri || !glad_glGetProgramBinary || !glad_glProgramBinary) return "";
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) return "";
+
+    const char* parts[] = {
+        vertexSource,
+        fragmentSource,
+        reinterpret_cast<const char*>(glGetString(GL_VENDOR)),
+        reinterpret_cast<const char*>(glGetString(GL_RENDERER)),
+        reinterpret_cast<const char*>(glGetString(GL_VERSION))
+    };
+    uint64_t hash = 14695981039346656037ull; // FNV-1a
+    for (const char* part : parts) {
+        if (!part) part = "";
+        for (const char* c = part; ; ++c) {
+            hash = (hash ^ (unsigned char)*c) * 1099511628211ull;
+            if (!*c) break; // Hash the terminator too so part boundaries matter
+        }
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)hash);
+    return std::string(CACHE_DIRECTORY) + "/" + name;
+}
+
+bool ShaderProgram::loadBinary(const std::string& path, double& compileMs) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    BinaryHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) != 0 || header.length == 0) {
+        return false;
+    }
+    std::vector<char> binary(header.length);
+    if (!file.read(binary.data(), binary.size())) return false;
+
+    id = glCreateProgram();
+    glProgramBinary(id, header.format, binary.data(), binary.size());
+    GLint success;
+    glGetProgramiv(id, GL_LINK_STATUS, &success);
+    if (!success) {
+        // The driver rejected the binary; it is overwritten after recompiling
+        glDeleteProgram(id);
+        id = 0;
+        return false;
+    }
+    compileMs = header.compileMs;
+    return true;
+}
+
+void ShaderProgram::saveBinary(const std::string& path, double compileMs) const {
+    GLint length = 0;
+    glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    BinaryHeader header;
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    std::vector<char> binary(length);
+    GLsizei written = 0;
+    glGetProgramBinary(id, length, &written, &header.format, binary.data());
+    if (written <= 0) return;
+    header.length = written;
+    header.compileMs = compileMs;
+
+    std::error_code ec;
+    std::filesystem::create_directories(CACHE_DIRECTORY, ec);
+    std::string tempPath = path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), written);
+        if (!file) return;
+    }
+    // Rename so a concurrently starting instance never reads a partial file;
+    // each instance writes its own temporary
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::cerr << "Failed to write shader cache " << path << ": " << ec.message() << std::endl;
+    }
+}
+
+const ProgramCacheStats& ShaderProgram::getCacheStats() {
+    return cacheStats;
+}
+
+ShaderProgram::~ShaderProgram() {
+    glDeleteProgram(id);
+}
+
+void ShaderProgram::reflect() {
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> buffer(maxLength > 0 ? maxLength : 1);
+
+    slots.clear();
+    slotIndex.clear();
+    for (GLint i = 0; i < count; ++i) {
+        GLint size;
+        GLenum type;
+        GLsizei length;
+        glGetActiveUniform(id, i, buffer.size(), &length, &size, &type, buffer.data());
+        std::string name(buffer.data(), length);
+        GLint location = glGetUniformLocation(id, name.c_str());
+        if (location < 0) continue; // Uniform block members have no location
+
+        // Arrays are reported as "name[0]"; expose them under the bare name too
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) {
+            slotIndex[name.substr(0, name.size() - 3)] = slots.size();
+        }
+        slotIndex[name] = slots.size();
+        slots.push_back({name, type, location, false, {}});
+    }
+}
+
+int ShaderProgram::findSlot(const std::string& name) const {
+    auto it = slotIndex.find(name);
+    return it != slotIndex.end() ? it->second : -1;
+}
+
+// Returns false if the program has no active block of that name.
+bool ShaderProgram::bindUniformBlock(const char* name, GLuint binding) {
+    GLuint index = glGetUniformBlockIndex(id, name);
+    if (index == GL_INVALID_INDEX) return false;
+    glUniformBlockBinding(id, index, binding);
+    return true;
+}
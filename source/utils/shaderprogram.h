@@ -0,0 +1,122 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+template<typename T> struct UniformTraits;
+
+template<> struct UniformTraits<int> {
+    static bool accepts(GLenum type) { return type == GL_INT || type == GL_BOOL || type == GL_SAMPLER_2D || type == GL_SAMPLER_BUFFER || type == GL_INT_SAMPLER_BUFFER || type == GL_UNSIGNED_INT_SAMPLER_BUFFER; }
+    static void upload(GLint loc, const int& v) { glUniform1i(loc, v); }
+};
+template<> struct UniformTraits<float> {
+    static bool accepts(GLenum type) { return type == GL_FLOAT; }
+    static void upload(GLint loc, const float& v) { glUniform1f(loc, v); }
+};
+template<> struct UniformTraits<glm::vec3> {
+    static bool accepts(GLenum type) { return type == GL_FLOAT_VEC3; }
+    static void upload(GLint loc, const glm::vec3& v) { glUniform3fv(loc, 1, &v[0]); }
+};
+template<> struct UniformTraits<glm::vec4> {
+    static bool accepts(GLenum type) { return type == GL_FLOAT_VEC4; }
+    static void upload(GLint loc, const glm::vec4& v) { glUniform4fv(loc, 1, &v[0]); }
+};
+template<> struct UniformTraits<glm::mat4> {
+    static bool accepts(GLenum type) { return type == GL_FLOAT_MAT4; }
+    static void upload(GLint loc, const glm::mat4& v) { glUniformMatrix4fv(loc, 1, GL_FALSE, &v[0][0]); }
+};
+
+// Program binary cache counters for this run; savedMs is the compile time
+// recorded when each hit was first built, minus the time to load it.
+struct ProgramCacheStats {
+    int hits;
+    int misses;
+    double compileMs;
+    double loadMs;
+    double savedMs;
+};
+
+// A linked GL program whose active uniforms are resolved once at link time.
+// Linked binaries are cached under CACHE_DIRECTORY, keyed by the sources and
+// the driver strings; a missing or rejected binary falls back to compiling.
+class ShaderProgram {
+public:
+    struct Slot {
+        std::string name;
+        GLenum type;
+        GLint location;
+        bool valid;                    // Whether cache holds the last uploaded value
+        unsigned char cache[sizeof(glm::mat4)];
+    };
+
+private:
+    GLuint id;
+    std::vector<Slot> slots;
+    std::unordered_map<std::string, int> slotIndex;
+
+    void reflect();
+    static std::string cachePath(const char* vertexSource, const char* fragmentSource);
+    bool loadBinary(const std::string& path, double& compileMs);
+    void saveBinary(const std::string& path, double compileMs) const;
+    // retrievable asks the driver to keep the binary for saveBinary()
+    void compileAndLink(const char* vertexSource, const char* fragmentSource, const char* label, bool retrievable);
+
+public:
+    static const char* CACHE_DIRECTORY;
+
+    ShaderProgram(const char* vertexSource, const char* fragmentSource, const char* label = "Shader");
+    ~ShaderProgram();
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+    GLuint getId() const { return id; }
+    void use() const { glUseProgram(id); }
+    int findSlot(const std::string& name) const;
+    bool bindUniformBlock(const char* name, GLuint binding);
+    Slot& getSlot(int slot) { return slots[slot]; }
+    const std::vector<Slot>& getSlots() const { return slots; }
+
+    static const ProgramCacheStats& getCacheStats();
+
+    template<typename T> class Uniform;
+    template<typename T> Uniform<T> uniform(const std::string& name);
+};
+
+// Typed handle to one uniform. set() uploads only when the value differs
+// from the last one sent; the owning program must be in use.
+template<typename T>
+class ShaderProgram::Uniform {
+private:
+    ShaderProgram* program;
+    int slot;
+
+public:
+    Uniform() : program(nullptr), slot(-1) {}
+    Uniform(ShaderProgram* program, int slot) : program(program), slot(slot) {}
+    bool isActive() const { return program && slot >= 0; }
+    void set(const T& value) {
+        if (!isActive()) return;
+        Slot& s = program->getSlot(slot);
+        if (s.valid && std::memcmp(s.cache, &value, sizeof(T)) == 0) return;
+        std::memcpy(s.cache, &value, sizeof(T));
+        s.valid = true;
+        UniformTraits<T>::upload(s.location, value);
+    }
+};
+
+template<typename T> using Uniform = ShaderProgram::Uniform<T>;
+
+// Inactive (optimized out or absent) uniforms yield a handle whose set() is a no-op.
+template<typename T>
+ShaderProgram::Uniform<T> ShaderProgram::uniform(const std::string& name) {
+    int slot = findSlot(name);
+    if (slot >= 0 && !UniformTraits<T>::accepts(slots[slot].type)) {
+        throw std::runtime_error("Uniform type mismatch: " + name);
+    }
+    return Uniform<T>(this, slot);
+}
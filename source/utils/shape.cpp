@@ -1,21 +1,35 @@
 
 #include "shape.h"
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <stdexcept>
 #include <iostream>
+#include <algorithm>
+#include <unordered_set>
 
-Shape::Shape(const std::string& type) : type(type), position(0.0f), scale(1.0f), rotation(0.0f), color(1.0f), vao(0), vbo(0), ebo(0) {}
+Shape::Shape(ShapeStore& store, const std::string& type) : type(type), store(&store), id(store.add(this)) {
+    store.positions[id] = glm::vec3(0.0f);
+    store.scales[id] = glm::vec3(1.0f);
+    store.rotations[id] = glm::vec3(0.0f);
+    store.colors[id] = glm::vec4(1.0f);
+    store.parents[id] = ShapeStore::NO_ID;
+    store.modelMatrices[id] = glm::mat4(1.0f);
+    store.instanceDirty[id] = true;
+    store.markTransformDirty(id);
+    store.hierarchyChanged = true;
+}
+
+Shape::~Shape() {}
 
-Shape::~Shape() {
-    glDeleteVertexArrays(1, &vao);
-    glDeleteBuffers(1, &vbo);
-    glDeleteBuffers(1, &ebo);
+void Shape::init(GeometryCache& cache) {
+    store->geometries[id] = cache.acquirePrimitive(type);
+    store->markTransformDirty(id); // World bounds depend on the geometry
 }
 
-void Shape::init() {
-    if (!glad_glGenVertexArrays) {
-        throw std::runtime_error("OpenGL not initialized");
-    }
+void Shape::buildPrimitive(const std::string& type, MeshData& mesh) {
+    mesh.clear();
+    std::vector<float>& vertices = mesh.positions;
+    std::vector<uint32_t>& indices = mesh.indices;
 
     if (type == "Cube") {
         vertices = {
@@ -54,30 +68,129 @@ void Shape::init() {
     } else {
         throw std::runtime_error("Unsupported shape type: " + type);
     }
+}
+
+bool ShapeStore::setParent(uint32_t id, uint32_t parent) {
+    if (parents[id] == parent) return true;
+    for (uint32_t ancestor = parent; ancestor != NO_ID; ancestor = parents[ancestor]) {
+        if (ancestor == id) return false;
+    }
+    parents[id] = parent;
+    hierarchyChanged = true;
+    markTransformDirty(id); // Now relative to the new parent
+    return true;
+}
+
+void ShapeStore::updateOrder() {
+    // Bucket the children of each shape, in id order
+    uint32_t count = size();
+    std::vector<uint32_t> childStarts(count + 1, 0);
+    for (uint32_t id = 0; id < count; ++id) {
+        if (parents[id] != NO_ID) ++childStarts[parents[id] + 1];
+    }
+    for (uint32_t id = 1; id <= count; ++id) {
+        childStarts[id] += childStarts[id - 1];
+    }
+    std::vector<uint32_t> children(childStarts[count]);
+    std::vector<uint32_t> cursors(childStarts.begin(), childStarts.end() - 1);
+    for (uint32_t id = 0; id < count; ++id) {
+        if (parents[id] != NO_ID) children[cursors[parents[id]]++] = id;
+    }
+
+    // Depth-first preorder from the roots, so every subtree is contiguous
+    order.clear();
+    order.reserve(count);
+    std::vector<uint32_t> stack;
+    for (uint32_t id = count; id-- > 0;) {
+        if (parents[id] == NO_ID) stack.push_back(id);
+    }
+    while (!stack.empty()) {
+        uint32_t id = stack.back();
+        stack.pop_back();
+        order.push_back(id);
+        for (uint32_t child = childStarts[id + 1]; child-- > childStarts[id];) {
+            stack.push_back(children[child]);
+        }
+    }
 
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glGenBuffers(1, &ebo);
-
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindVertexArray(0);
+    // Children follow their parents, so walking backwards sums subtree sizes
+    std::vector<uint32_t> subtreeSizes(count, 1);
+    subtreeEnds.resize(count);
+    for (uint32_t pos = count; pos-- > 0;) {
+        uint32_t id = order[pos];
+        subtreeEnds[pos] = pos + subtreeSizes[id];
+        if (parents[id] != NO_ID) subtreeSizes[parents[id]] += subtreeSizes[id];
+    }
+    hierarchyChanged = false;
 }
 
-void Shape::draw(GLuint shaderProgram) {
-    glBindVertexArray(vao);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+void ShapeStore::updateTransform(uint32_t id) {
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, positions[id]);
+    model = glm::rotate(model, glm::radians(rotations[id].x), glm::vec3(1.0f, 0.0f, 0.0f));
+    model = glm::rotate(model, glm::radians(rotations[id].y), glm::vec3(0.0f, 1.0f, 0.0f));
+    model = glm::rotate(model, glm::radians(rotations[id].z), glm::vec3(0.0f, 0.0f, 1.0f));
+    model = glm::scale(model, scales[id]);
+    if (parents[id] != NO_ID) {
+        model = modelMatrices[parents[id]] * model;
+    }
+    modelMatrices[id] = model;
+    if (geometries[id]) {
+        worldBounds[id] = geometries[id]->bounds.transformed(model);
+    }
+    transformDirty[id] = false;
+    instanceDirty[id] = true;
+}
+
+void ShapeStore::updateTransforms() {
+    if (hierarchyChanged || order.size() != size()) updateOrder();
+    if (!transformsChanged) return;
+    // A dirty shape's subtree follows it in order; recompute up to its end
+    uint32_t dirtyEnd = 0;
+    for (uint32_t pos = 0; pos < order.size(); ++pos) {
+        uint32_t id = order[pos];
+        if (transformDirty[id]) dirtyEnd = std::max(dirtyEnd, subtreeEnds[pos]);
+        if (pos < dirtyEnd) updateTransform(id);
+    }
+    transformsChanged = false;
+}
+
+void ShapeStore::addDescendants(std::vector<Shape*>& listed) {
+    if (hierarchyChanged || order.size() != size()) updateOrder();
+    std::unordered_set<const Shape*> known(listed.begin(), listed.end());
+    uint32_t listedEnd = 0;
+    for (uint32_t pos = 0; pos < order.size(); ++pos) {
+        Shape* view = views[order[pos]];
+        if (known.count(view)) {
+            listedEnd = std::max(listedEnd, subtreeEnds[pos]);
+        } else if (pos < listedEnd) {
+            listed.push_back(view);
+        }
+    }
+}
+
+void ShapeStore::idsRemapped(const std::vector<uint32_t>& newIds) {
+    for (uint32_t id = 0; id < size(); ++id) {
+        if (parents[id] == NO_ID) continue;
+        parents[id] = newIds[parents[id]];
+        if (parents[id] == NO_ID) markTransformDirty(id); // Orphans become roots
+    }
+    hierarchyChanged = true;
+}
+
+void ShapeStore::appended(ShapeStore& other, uint32_t first) {
+    for (uint32_t id = first; id < size(); ++id) {
+        if (parents[id] != NO_ID) parents[id] += first;
+    }
+    transformsChanged = transformsChanged || other.transformsChanged;
+    hierarchyChanged = true;
+    other.transformsChanged = false;
+    other.hierarchyChanged = true;
 }
 
-Shape* Shape::createShape(const std::string& type) {
-    if (type == "Circle" || type == "Cube" || type == "Triangle") {
-        return new Shape(type);
+Shape* Shape::createShape(ShapeStore& store, const std::string& type) {
+    if (isPrimitive(type)) {
+        return new Shape(store, type);
     } else if (type == "Mesh") {
         return nullptr; // Mesh requires objPath, handled in Renderer
     }
@@ -1,37 +1,100 @@
-
 #pragma once
 #include <string>
 #include <vector>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/ext/matrix_transform.hpp>
+#include "geometry.h"
+#include "entitystore.h"
+
+class Shape;
+
+// Components of every shape, one array each. Per-frame passes (transforms,
+// instance data, snapshots) run over these arrays and never touch views.
+// Shapes form a hierarchy through parents: a shape's position, rotation and
+// scale are relative to its parent. order lists the ids topologically, so
+// one sweep over it sees every parent before its children, and a subtree is
+// one contiguous range of it.
+class ShapeStore : public EntityStore<ShapeStore, Shape> {
+public:
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> scales;
+    std::vector<glm::vec3> rotations;       // Euler angles in degrees
+    std::vector<glm::vec4> colors;          // RGBA
+    std::vector<uint32_t> parents;          // Parent's id, NO_ID for roots
+    std::vector<glm::mat4> modelMatrices;   // Cached local-to-world transforms
+    std::vector<Bounds> worldBounds;        // Geometry bounds under modelMatrices
+    std::vector<GeometryHandle> geometries;
+    std::vector<uint8_t> transformDirty;    // Local transform changed; this and all descendants need recomputing
+    std::vector<uint8_t> instanceDirty;     // Matrix or color changed since the renderer last read them
+
+    auto columns() {
+        return std::tie(positions, scales, rotations, colors, parents, modelMatrices, worldBounds, geometries,
+                        transformDirty, instanceDirty);
+    }
+
+    ShapeStore() : hierarchyChanged(false), transformsChanged(false) {}
+    void markTransformDirty(uint32_t id) { transformDirty[id] = true; transformsChanged = true; }
+    // False if parent is id itself or one of its descendants; NO_ID detaches
+    bool setParent(uint32_t id, uint32_t parent);
+    // Appends the views of every descendant of the listed ones not already listed
+    void addDescendants(std::vector<Shape*>& listed);
+    // Recomputes the world transform of every dirty subtree in one sweep
+    void updateTransforms();
+
+private:
+    friend class EntityStore<ShapeStore, Shape>;
+    friend class Shape;
+    std::vector<uint32_t> order;        // Ids, each parent before its descendants
+    std::vector<uint32_t> subtreeEnds;  // Per order position, one past the last position of its subtree
+    bool hierarchyChanged;              // order is stale
+    bool transformsChanged;             // Some transformDirty flag is set
+
+    void updateOrder();
+    void updateTransform(uint32_t id);
+    void idsRemapped(const std::vector<uint32_t>& newIds);
+    void appended(ShapeStore& other, uint32_t first);
+};
 
+// Thin view of one entry of a ShapeStore, owned by the store
 class Shape {
 protected:
+    friend class EntityStore<ShapeStore, Shape>;
     std::string type;
-    GLuint vao, vbo, ebo;
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
-    glm::vec3 position; // Added
-    glm::vec3 scale;    // Added
-    glm::vec3 rotation; // Added (Euler angles in degrees)
-    glm::vec4 color;    // Added (RGBA)
+    ShapeStore* store;
+    uint32_t id;
 
 public:
-    Shape(const std::string& type);
+    // Adds a shape with default components to store
+    Shape(ShapeStore& store, const std::string& type);
     virtual ~Shape();
-    virtual void init();
-    virtual void draw(GLuint shaderProgram);
+    Shape(const Shape&) = delete;
+    Shape& operator=(const Shape&) = delete;
+    virtual void init(GeometryCache& cache);
     std::string getType() const { return type; }
-    static Shape* createShape(const std::string& type);
+    uint32_t getId() const { return id; }
+    static Shape* createShape(ShapeStore& store, const std::string& type);
+    static bool isPrimitive(const std::string& type) { return type == "Cube" || type == "Circle" || type == "Triangle"; }
+    static void buildPrimitive(const std::string& type, MeshData& mesh);
+    Geometry* getGeometry() const { return store->geometries[id].get(); }
+    bool isTransformDirty() const { return store->transformDirty[id]; }
+    // Bring every stale transform in the store up to date first
+    const glm::mat4& getModelMatrix() const { store->updateTransforms(); return store->modelMatrices[id]; }
+    const Bounds& getWorldBounds() const { store->updateTransforms(); return store->worldBounds[id]; }
+    Shape* getParent() const { return store->parents[id] == ShapeStore::NO_ID ? nullptr : store->views[store->parents[id]]; }
+    // Null detaches; false if parent is in another store or would form a cycle
+    bool setParent(Shape* parent) {
+        if (parent && parent->store != store) return false;
+        return store->setParent(id, parent ? parent->id : ShapeStore::NO_ID);
+    }
 
     // Getters and setters for properties
-    glm::vec3 getPosition() const { return position; }
-    void setPosition(const glm::vec3& pos) { position = pos; }
-    glm::vec3 getScale() const { return scale; }
-    void setScale(const glm::vec3& scl) { scale = scl; }
-    glm::vec3 getRotation() const { return rotation; }
-    void setRotation(const glm::vec3& rot) { rotation = rot; }
-    glm::vec4 getColor() const { return color; }
-    void setColor(const glm::vec4& col) { color = col; }
+    glm::vec3 getPosition() const { return store->positions[id]; }
+    void setPosition(const glm::vec3& pos) { store->positions[id] = pos; store->markTransformDirty(id); }
+    glm::vec3 getScale() const { return store->scales[id]; }
+    void setScale(const glm::vec3& scl) { store->scales[id] = scl; store->markTransformDirty(id); }
+    glm::vec3 getRotation() const { return store->rotations[id]; }
+    void setRotation(const glm::vec3& rot) { store->rotations[id] = rot; store->markTransformDirty(id); }
+    glm::vec4 getColor() const { return store->colors[id]; }
+    void setColor(const glm::vec4& col) { store->colors[id] = col; store->instanceDirty[id] = true; }
 };
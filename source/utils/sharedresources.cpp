@@ -0,0 +1,51 @@
+#include "sharedresources.h"
+#include <algorithm>
+
+std::vector<SharedResources*> SharedResources::groups;
+
+SharedResources::SharedResources() : geometryCache(new GeometryCache()) {}
+
+SharedResources::~SharedResources() {
+    for (auto& entry : programs) {
+        delete entry.second;
+    }
+    delete geometryCache;
+}
+
+SharedResources* SharedResources::acquire(SDL_GLContext context, SDL_GLContext shareWith) {
+    SharedResources* group = nullptr;
+    if (shareWith) {
+        for (SharedResources* candidate : groups) {
+            if (std::find(candidate->contexts.begin(), candidate->contexts.end(), shareWith) != candidate->contexts.end()) {
+                group = candidate;
+                break;
+            }
+        }
+    }
+    if (!group) {
+        group = new SharedResources();
+        groups.push_back(group);
+    }
+    group->contexts.push_back(context);
+    return group;
+}
+
+void SharedResources::release(SDL_GLContext context) {
+    contexts.erase(std::remove(contexts.begin(), contexts.end(), context), contexts.end());
+    if (!contexts.empty()) return;
+    groups.erase(std::remove(groups.begin(), groups.end(), this), groups.end());
+    delete this;
+}
+
+// Programs are keyed by their source text, so every renderer asking for
+// the same shaders gets the same linked program.
+ShaderProgram* SharedResources::getProgram(const char* vertexSource, const char* fragmentSource, const char* label) {
+    std::string key = std::string(vertexSource) + '\0' + fragmentSource;
+    auto it = programs.find(key);
+    if (it != programs.end()) {
+        return it->second;
+    }
+    ShaderProgram* program = new ShaderProgram(vertexSource, fragmentSource, label);
+    programs[key] = program;
+    return program;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <SDL2/SDL.h>
+#include "shaderprogram.h"
+#include "geometry.h"
+
+// GL objects shared by every context in one share group: linked programs
+// and the geometry cache. Per-context state (VAOs, framebuffers, buffer
+// bindings) stays with each Renderer.
+class SharedResources {
+private:
+    std::vector<SDL_GLContext> contexts;
+    std::unordered_map<std::string, ShaderProgram*> programs;
+    GeometryCache* geometryCache;
+
+    static std::vector<SharedResources*> groups;
+
+    SharedResources();
+    ~SharedResources();
+
+public:
+    SharedResources(const SharedResources&) = delete;
+    SharedResources& operator=(const SharedResources&) = delete;
+
+    // Joins the group that owns shareWith, or starts a new one when it is null.
+    static SharedResources* acquire(SDL_GLContext context, SDL_GLContext shareWith);
+    // Leaves the group; the last context frees the shared objects, so it must be current.
+    void release(SDL_GLContext context);
+
+    ShaderProgram* getProgram(const char* vertexSource, const char* fragmentSource, const char* label);
+    GeometryCache& getGeometryCache() { return *geometryCache; }
+    size_t getContextCount() const { return contexts.size(); }
+};
@@ -1,9 +1,9 @@
 #include "spotlight.h"
 
-Spotlight::Spotlight(const std::string& name)
-    : name(name),
-      position(0.0f, 0.0f, 0.0f),
-      direction(0.0f, 0.0f, -1.0f),
-      color(1.0f, 1.0f, 1.0f, 1.0f),
-      cutoff(12.5f),
-      intensity(1.0f) {}
+Spotlight::Spotlight(SpotlightStore& store, const std::string& name) : name(name), store(&store), id(store.add(this)) {
+    store.positions[id] = glm::vec3(0.0f, 0.0f, 0.0f);
+    store.directions[id] = glm::vec3(0.0f, 0.0f, -1.0f);
+    store.colors[id] = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+    store.cutoffs[id] = 12.5f;
+    store.intensities[id] = 1.0f;
+}
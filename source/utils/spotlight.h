@@ -1,28 +1,45 @@
-
 #pragma once
 #include <glm/glm.hpp>
 #include <string>
+#include "entitystore.h"
+
+class Spotlight;
+
+// Components of every spotlight, one array each
+class SpotlightStore : public EntityStore<SpotlightStore, Spotlight> {
+public:
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> directions;
+    std::vector<glm::vec4> colors;
+    std::vector<float> cutoffs;         // Inner cutoff angle (degrees)
+    std::vector<float> intensities;
+
+    auto columns() { return std::tie(positions, directions, colors, cutoffs, intensities); }
+};
 
+// Thin view of one entry of a SpotlightStore, owned by the store
 class Spotlight {
 private:
+    friend class EntityStore<SpotlightStore, Spotlight>;
     std::string name;
-    glm::vec3 position;
-    glm::vec3 direction;
-    glm::vec4 color;
-    float cutoff;   // Inner cutoff angle (degrees)
-    float intensity;
+    SpotlightStore* store;
+    uint32_t id;
 
 public:
-    Spotlight(const std::string& name);
+    // Adds a spotlight with default components to store
+    Spotlight(SpotlightStore& store, const std::string& name);
+    Spotlight(const Spotlight&) = delete;
+    Spotlight& operator=(const Spotlight&) = delete;
     std::string getName() const { return name; }
-    glm::vec3 getPosition() const { return position; }
-    void setPosition(const glm::vec3& pos) { position = pos; }
-    glm::vec3 getDirection() const { return direction; }
-    void setDirection(const glm::vec3& dir) { direction = dir; }
-    glm::vec4 getColor() const { return color; }
-    void setColor(const glm::vec4& col) { color = col; }
-    float getCutoff() const { return cutoff; }
-    void setCutoff(float c) { cutoff = c; }
-    float getIntensity() const { return intensity; }
-    void setIntensity(float i) { intensity = i; }
+    uint32_t getId() const { return id; }
+    glm::vec3 getPosition() const { return store->positions[id]; }
+    void setPosition(const glm::vec3& pos) { store->positions[id] = pos; }
+    glm::vec3 getDirection() const { return store->directions[id]; }
+    void setDirection(const glm::vec3& dir) { store->directions[id] = dir; }
+    glm::vec4 getColor() const { return store->colors[id]; }
+    void setColor(const glm::vec4& col) { store->colors[id] = col; }
+    float getCutoff() const { return store->cutoffs[id]; }
+    void setCutoff(float c) { store->cutoffs[id] = c; }
+    float getIntensity() const { return store->intensities[id]; }
+    void setIntensity(float i) { store->intensities[id] = i; }
 };
@@ -1,18 +1,28 @@
 
 #include "window.h"
 #include "renderer.h"
+#include "offscreentarget.h"
+#include "framereadback.h"
 #include <stdexcept>
 #include <iostream>
+#include <cstdio>
 #include <imgui/backends/imgui_impl_sdl2.h>
 
 bool Window::g_ImGuiInitialized = false;
 int Window::indice = 0;
 
-Window::Window(unsigned int width, unsigned int height, SDL_GLContext sharedContext, WindowType type) {
+Window::Window(unsigned int width, unsigned int height, SDL_GLContext sharedContext, WindowType type, bool headless) {
     this->type = type;
     this->width = width;
     this->height = height;
+    this->sampledWidth = width;
+    this->sampledHeight = height;
     this->aspect = static_cast<float>(width) / height;
+    this->presentStats = PresentStats();
+    this->drawsImGui = true;
+    this->offscreen = nullptr;
+    this->readback = nullptr;
+    this->capturedFrames = 0;
 
     static bool sdlInitialized = false;
     if (!sdlInitialized) {
@@ -27,10 +37,15 @@ Window::Window(unsigned int width, unsigned int height, SDL_GLContext sharedCont
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
     SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+    // Sharing happens with the context current at creation; windows are
+    // created in sequence, so that is the previous one in the group
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, sharedContext ? 1 : 0);
 
-    std::string defaultTitle = std::string("Window ") + std::to_string(indice++);
+    number = indice++;
+    std::string defaultTitle = std::string("Window ") + std::to_string(number);
+    Uint32 flags = SDL_WINDOW_OPENGL | (headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_RESIZABLE);
     window = SDL_CreateWindow(defaultTitle.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                              width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+                              width, height, flags);
     if (!window) {
         if (!sdlInitialized) SDL_Quit();
         throw std::runtime_error("Failed to create SDL window: " + std::string(SDL_GetError()));
@@ -50,9 +65,15 @@ Window::Window(unsigned int width, unsigned int height, SDL_GLContext sharedCont
         throw std::runtime_error("Failed to initialize GLAD");
     }
 
-    SDL_GL_SetSwapInterval(1);
+    // Swap intervals are chosen by PresentScheduler; only its primary waits for vblank
+    SDL_GL_SetSwapInterval(0);
 
-    renderer = new Renderer(nullptr, nullptr);
+    if (headless) {
+        offscreen = new OffscreenTarget();
+        offscreen->init(width, height);
+    }
+
+    renderer = new Renderer(nullptr, nullptr, sharedContext);
     renderer->SetType(type);
     renderer->SetWindow(this);
 
@@ -68,6 +89,12 @@ Window::Window(unsigned int width, unsigned int height, SDL_GLContext sharedCont
 }
 
 Window::~Window() {
+    SDL_GL_MakeCurrent(window, glContext); // The renderer frees GL objects
+    if (readback) {
+        readback->finish();
+        delete readback;
+    }
+    delete offscreen;
     delete renderer;
     SDL_GL_DeleteContext(glContext);
     SDL_DestroyWindow(window);
@@ -79,6 +106,7 @@ void Window::SetTitle(const char* title) {
 }
 
 void Window::Show() {
+    if (offscreen) return;
     SDL_ShowWindow(window);
 }
 
@@ -95,44 +123,74 @@ void Window::LoadFromJSON(const nlohmann::json& json) {
         json.contains("height") && json["height"].is_number_unsigned()) {
         width = json["width"].get<unsigned int>();
         height = json["height"].get<unsigned int>();
+        sampledWidth = width;
+        sampledHeight = height;
         aspect = static_cast<float>(width) / height;
         SDL_SetWindowSize(window, width, height);
     }
 
-    if (json.contains("shapes") && json["shapes"].is_array()) {
-        renderer->loadFromJSON(json);
-        renderer->init();
-    }
+    // Entities listed per window are read by SceneLoader; the window keeps only its camera
+    renderer->init();
 
     if (json.contains("camera") && json["camera"].is_object()) {
         nlohmann::json cameraJson = json["camera"];
         cameraJson["aspect"] = aspect;
-        renderer->loadFromJSON({{"camera", cameraJson}, {"shapes", json["shapes"]}});
+        renderer->loadFromJSON({{"camera", cameraJson}});
     }
 }
 
-void Window::Draw(int* state, std::vector<Renderer*>& allRenderers) {
+nlohmann::json Window::ToJSON() const {
+    const char* typeNames[] = {"WINDOW_MAIN", "WINDOW_DEBUG", "WINDOW_HIERARCHY", "WINDOW_GUI"};
+    nlohmann::json json = {
+        {"type", typeNames[type]},
+        {"title", title},
+        {"width", width},
+        {"height", height}
+    };
+    if (const Camera* camera = renderer->getCamera()) {
+        glm::vec3 position = camera->getPosition();
+        glm::vec3 rotation = camera->getRotation();
+        json["camera"] = {
+            {"position", {position.x, position.y, position.z}},
+            {"rotation", {rotation.x, rotation.y, rotation.z}},
+            {"fov", camera->getFov()}
+        };
+    }
+    return json;
+}
+
+void Window::SampleSize() {
+    SDL_GetWindowSize(window, &sampledWidth, &sampledHeight);
+}
+
+void Window::Draw(const SceneSnapshot& snapshot, int* state, std::vector<Renderer*>& allRenderers) {
     if (SDL_GL_MakeCurrent(window, glContext) < 0) {
         throw std::runtime_error("Failed to make GL context current: " + std::string(SDL_GetError()));
     }
 
-    int newWidth, newHeight;
-    SDL_GetWindowSize(window, &newWidth, &newHeight);
-    if (newWidth != width || newHeight != height) {
-        width = newWidth;
-        height = newHeight;
+    if (sampledWidth > 0 && sampledHeight > 0 && ((unsigned int)sampledWidth != width || (unsigned int)sampledHeight != height)) {
+        width = sampledWidth;
+        height = sampledHeight;
         aspect = static_cast<float>(width) / height;
-        ImGuiIO& io = ImGui::GetIO();
-        io.DisplaySize = ImVec2(static_cast<float>(width), static_cast<float>(height));
+        if (drawsImGui) {
+            ImGuiIO& io = ImGui::GetIO();
+            io.DisplaySize = ImVec2(static_cast<float>(width), static_cast<float>(height));
+        }
         renderer->updateCameraAspect(aspect);
     }
+    if (offscreen) {
+        offscreen->resize(width, height);
+        offscreen->bind();
+    }
 
     glViewport(0, 0, width, height);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glEnable(GL_DEPTH_TEST);
 
-    if (type == WINDOW_HIERARCHY) {
+    if (!drawsImGui) {
+        renderer->render(snapshot);
+    } else if (type == WINDOW_HIERARCHY) {
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplSDL2_NewFrame();
         ImGui::NewFrame();
@@ -140,7 +198,7 @@ void Window::Draw(int* state, std::vector<Renderer*>& allRenderers) {
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
     } else {
-        renderer->render();
+        renderer->render(snapshot);
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplSDL2_NewFrame();
         ImGui::NewFrame();
@@ -148,6 +206,25 @@ void Window::Draw(int* state, std::vector<Renderer*>& allRenderers) {
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
     }
+}
+
+// Expects this window's context to be current, as Draw leaves it
+void Window::Present() {
+    if (!offscreen) {
+        SDL_GL_SwapWindow(window);
+        return;
+    }
 
-    SDL_GL_SwapWindow(window);
+    if (!captureDirectory.empty()) {
+        if (!readback) {
+            readback = new FrameReadback();
+            readback->init();
+        }
+        readback->poll();
+        char name[64];
+        snprintf(name, sizeof(name), "/window%d_%05llu.ppm", number, (unsigned long long)capturedFrames++);
+        readback->capture(offscreen->getWidth(), offscreen->getHeight(), captureDirectory + name);
+    }
+    // Nothing swaps, so submit the frame explicitly
+    glFlush();
 }
@@ -4,9 +4,13 @@
 #include <string>
 #include <nlohmann/json.hpp>
 #include <vector>
+#include <cstdint>
 
 // Forward declaration of Renderer
 class Renderer;
+struct SceneSnapshot;
+class OffscreenTarget;
+class FrameReadback;
 
 // Define WindowType enum
 enum WindowType {
@@ -16,25 +20,71 @@ enum WindowType {
     WINDOW_GUI
 };
 
+// Presentation timings kept by PresentScheduler, averaged over recent frames
+struct PresentStats {
+    double drawMs;          // Rendering and UI, excluding the swap
+    double latencyMs;       // Frame start to swap return
+    uint64_t presentedFrames;
+    uint64_t deferredFrames;
+    int deferredInARow;
+
+    void record(double frameDrawMs, double frameLatencyMs) {
+        const double smoothing = 0.1; // Weight of the newest sample
+        if (presentedFrames == 0) {
+            drawMs = frameDrawMs;
+            latencyMs = frameLatencyMs;
+        } else {
+            drawMs += (frameDrawMs - drawMs) * smoothing;
+            latencyMs += (frameLatencyMs - latencyMs) * smoothing;
+        }
+        ++presentedFrames;
+        deferredInARow = 0;
+    }
+};
+
 class Window {
 private:
     SDL_Window* window;
     SDL_GLContext glContext;
     unsigned int width, height;
+    int sampledWidth, sampledHeight;    // Size read by SampleSize(), applied by the next Draw
     float aspect;
     std::string title;
     static int indice;
     static bool g_ImGuiInitialized;
+    PresentStats presentStats;
+    bool drawsImGui;
+    int number;                      // Creation order, names captured frames
+    OffscreenTarget* offscreen;      // Set for headless windows, which never swap
+    FrameReadback* readback;
+    std::string captureDirectory;
+    uint64_t capturedFrames;
 
 public:
     Renderer* renderer;
     WindowType type;
-    Window(unsigned int width, unsigned int height, SDL_GLContext sharedContext = nullptr, WindowType type = WINDOW_MAIN);
+    // A headless window stays hidden and renders into an offscreen target
+    Window(unsigned int width, unsigned int height, SDL_GLContext sharedContext = nullptr, WindowType type = WINDOW_MAIN, bool headless = false);
     ~Window();
     void SetTitle(const char* title);
     void Show();
     void LoadFromJSON(const nlohmann::json& json);
-    void Draw(int* state, std::vector<Renderer*>& allRenderers);
+    // Settings in the form LoadFromJSON reads, with the camera as it is now
+    nlohmann::json ToJSON() const;
+    // SDL video calls are main-thread only, while Draw may run on a render
+    // thread; call this on the main thread before handing the frame over
+    void SampleSize();
+    void Draw(const SceneSnapshot& snapshot, int* state, std::vector<Renderer*>& allRenderers);
+    void Present();
+    PresentStats& GetPresentStats() { return presentStats; }
+    // ImGui has one context and must stay on the main thread; windows drawn
+    // by a render thread turn it off
+    void SetDrawsImGui(bool enabled) { drawsImGui = enabled; }
+    bool IsHeadless() const { return offscreen != nullptr; }
+    // Headless windows write every presented frame there as PPM; empty turns it off
+    void SetCaptureDirectory(const std::string& directory) { captureDirectory = directory; }
+    unsigned int GetWidth() const { return width; }
+    unsigned int GetHeight() const { return height; }
     SDL_Window* GetWindow() const { return window; }
     SDL_GLContext GetGLContext() const { return glContext; } // Added
 };